@@ -60,6 +60,8 @@ public:
 	}tilemapSize;
 
 	Animation() = default;
+	// AnimationSlot deletes through Animation*
+	virtual ~Animation() = default;
 
 	Animation(std::string tilemapParam, float frameDurationParam, int tilemapSizeParam[2], bool loopParam, std::vector <int> manualMode) {
 		tilemapPath = tilemapParam;
@@ -71,4 +73,32 @@ public:
 	}
 	virtual void OnAnimationEnd() {};
 	int GetSpriteWidth();
+};
+
+// Owns the animation of a GameObject. Assigning a new one deletes the one it replaces, so clips
+// can still be switched with animation = new Animation(...). Switch clips outside OnAnimationFinish
+// or together with isInit = false, the engine stops using the old clip at that point.
+class AnimationSlot
+{
+public:
+	AnimationSlot() = default;
+	AnimationSlot(const AnimationSlot&) = delete;
+	AnimationSlot& operator=(const AnimationSlot&) = delete;
+	~AnimationSlot() { delete m_Animation; }
+
+	AnimationSlot& operator=(Animation* animation)
+	{
+		if (animation != m_Animation)
+		{
+			delete m_Animation;
+			m_Animation = animation;
+		}
+		return *this;
+	}
+
+	Animation* operator->() const { return m_Animation; }
+	operator Animation*() const { return m_Animation; }
+
+private:
+	Animation* m_Animation = nullptr;
 };
\ No newline at end of file
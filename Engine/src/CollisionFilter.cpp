@@ -0,0 +1,67 @@
+#include "CollisionFilter.h"
+
+#include <iostream>
+
+namespace GameEngine {
+
+	CollisionFilter::CollisionFilter()
+		: m_Masks(kMaxCategories, ~std::uint64_t(0))
+	{
+	}
+
+	int CollisionFilter::GetIndex(Tag group)
+	{
+		int index = group.GetId();
+		if (index < kMaxCategories)
+			return index;
+
+		if (!m_SharedWarned.Contains(group))
+		{
+			std::cout << "Collision group " << group.GetName() << " shares the last category, there are more than " << kMaxCategories << " groups" << std::endl;
+			m_SharedWarned.Add(group);
+		}
+		return kMaxCategories - 1;
+	}
+
+	std::uint64_t CollisionFilter::GetCategory(Tag group)
+	{
+		return std::uint64_t(1) << GetIndex(group);
+	}
+
+	std::uint64_t CollisionFilter::GetMask(Tag group)
+	{
+		return m_Masks[GetIndex(group)];
+	}
+
+	void CollisionFilter::SetCollides(Tag groupA, Tag groupB, bool collides)
+	{
+		int a = GetIndex(groupA);
+		int b = GetIndex(groupB);
+		std::uint64_t bitA = std::uint64_t(1) << a;
+		std::uint64_t bitB = std::uint64_t(1) << b;
+
+		if (collides)
+		{
+			m_Masks[a] |= bitB;
+			m_Masks[b] |= bitA;
+		}
+		else
+		{
+			m_Masks[a] &= ~bitB;
+			m_Masks[b] &= ~bitA;
+		}
+	}
+
+	void CollisionFilter::SetCollidesWithAll(Tag group, bool collides)
+	{
+		int index = GetIndex(group);
+		std::uint64_t bit = std::uint64_t(1) << index;
+
+		for (std::uint64_t& mask : m_Masks)
+		{
+			mask = collides ? (mask | bit) : (mask & ~bit);
+		}
+		m_Masks[index] = collides ? ~std::uint64_t(0) : 0;
+	}
+
+}
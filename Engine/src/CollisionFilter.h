@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "TagRegistry.h"
+
+namespace GameEngine {
+
+	// Turns object group tags into Box2D filter categories and keeps the matrix of which
+	// groups collide. The category bit of a group is its tag id. Two shapes only reach the narrowphase if each one's mask has the
+	// other's category, so a pair switched off here never produces a contact event.
+	// Every group collides with every group until told otherwise.
+	class CollisionFilter
+	{
+	public:
+		static const int kMaxCategories = 64;
+
+		CollisionFilter();
+
+		// Tags past kMaxCategories share the last bit
+		std::uint64_t GetCategory(Tag group);
+		std::uint64_t GetMask(Tag group);
+
+		// Both directions, groupA and groupB may be the same group
+		void SetCollides(Tag groupA, Tag groupB, bool collides);
+		// Sets the group's row and column of the matrix at once
+		void SetCollidesWithAll(Tag group, bool collides);
+
+	private:
+		int GetIndex(Tag group);
+
+		std::vector<std::uint64_t> m_Masks; // one per category
+		TagSet m_SharedWarned;
+	};
+
+}
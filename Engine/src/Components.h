@@ -0,0 +1,65 @@
+#pragma once
+#include "GameObjects.h"
+
+namespace GameEngine {
+
+	// Built-in components of the EntityWorld the engine updates and draws. Positions and sizes
+	// are in the same pixel units as GameObject::position and GameObject::collisionBoxSize.
+
+	struct Transform
+	{
+		float x = 0.f;
+		float y = 0.f;
+		// Position before the last tick, sprites are drawn in between like level objects
+		float previousX = 0.f;
+		float previousY = 0.f;
+		float rotation = 0.f;
+	};
+
+	// Pixels per second, moves the Transform every tick
+	struct Velocity
+	{
+		float x = 0.f;
+		float y = 0.f;
+	};
+
+	// One frame of a sprite sheet, texture from Engine::acquireTexture
+	struct Sprite
+	{
+		unsigned int texture = 0;
+		float w = 32.f;
+		float h = 32.f;
+		float u0 = 0.f, v0 = 0.f, u1 = 1.f, v1 = 1.f;
+		RenderLayer layer = RenderLayer::Enemies;
+		int r = 255, g = 255, b = 255;
+	};
+
+	// Box and group the way level objects have them. The engine keeps it current for legacy
+	// objects, plain entities are not tested against anything yet.
+	struct Collider
+	{
+		float w = 32.f;
+		float h = 32.f;
+		Tag group;
+	};
+
+	struct Health
+	{
+		int points = 1;
+	};
+
+	// Seconds left, the engine destroys the entity once they run out
+	struct Lifetime
+	{
+		float seconds = 1.f;
+	};
+
+	// Every level object has an entity with its Transform, Collider and this, so systems see
+	// GameObject subclasses and plain entities alike while the game moves over. Engine::syncLegacyEntities
+	// brings Transform and Collider up to date, the engine does not copy them every tick.
+	struct LegacyObject
+	{
+		GameObject* object = nullptr;
+	};
+
+}
@@ -0,0 +1,134 @@
+#include "ContactDispatcher.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace GameEngine {
+
+	void ContactDispatcher::SetHandler(Tag groupA, Tag groupB, Handler handler)
+	{
+		int a = groupA.GetId();
+		int b = groupB.GetId();
+
+		// The table only grows when handlers are set, tags interned later fall outside and use OnCollideEnter
+		int size = TagRegistry::GetCount();
+		if (size > m_TableSize)
+		{
+			std::vector<Entry> table(size * size);
+			for (int row = 0; row < m_TableSize; ++row)
+				for (int column = 0; column < m_TableSize; ++column)
+					table[row * size + column] = m_Table[row * m_TableSize + column];
+			m_Table.swap(table);
+			m_TableSize = size;
+		}
+
+		m_Table[a * m_TableSize + b].handler = handler;
+		m_Table[a * m_TableSize + b].swap = false;
+		if (a != b)
+		{
+			m_Table[b * m_TableSize + a].handler = handler;
+			m_Table[b * m_TableSize + a].swap = true;
+		}
+	}
+
+	void ContactDispatcher::AddBegin(GameObject& a, GameObject& b)
+	{
+		m_Begins.push_back({ &a, &b });
+	}
+
+	void ContactDispatcher::AddEnd(GameObject& a, GameObject& b)
+	{
+		m_Ends.push_back({ &a, &b });
+	}
+
+	void ContactDispatcher::RemoveDuplicates(std::vector<Event>& events)
+	{
+		int count = (int)events.size();
+		if (count < 2)
+			return;
+
+		// Both orders of a pair share one key, the lower pointer first
+		std::less<GameObject*> less;
+		m_Keys.resize(count);
+		for (int i = 0; i < count; ++i)
+		{
+			const Event& event = events[i];
+			m_Keys[i] = less(event.a, event.b) ? Event{ event.a, event.b } : Event{ event.b, event.a };
+		}
+
+		// Sorting indices by key and then index keeps the first report of every pair
+		m_Order.resize(count);
+		for (int i = 0; i < count; ++i)
+			m_Order[i] = i;
+		std::sort(m_Order.begin(), m_Order.end(), [&](int x, int y) {
+			const Event& kx = m_Keys[x];
+			const Event& ky = m_Keys[y];
+			if (kx.a != ky.a)
+				return less(kx.a, ky.a);
+			if (kx.b != ky.b)
+				return less(kx.b, ky.b);
+			return x < y;
+		});
+
+		m_Keep.assign(count, false);
+		m_Keep[m_Order[0]] = true;
+		for (int i = 1; i < count; ++i)
+		{
+			const Event& previous = m_Keys[m_Order[i - 1]];
+			const Event& current = m_Keys[m_Order[i]];
+			if (previous.a != current.a || previous.b != current.b)
+				m_Keep[m_Order[i]] = true;
+		}
+
+		int kept = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			if (m_Keep[i])
+				events[kept++] = events[i];
+		}
+		events.resize(kept);
+	}
+
+	void ContactDispatcher::Begin(GameObject& a, GameObject& b)
+	{
+		int idA = a.objectGroup.GetId();
+		int idB = b.objectGroup.GetId();
+		if (idA < m_TableSize && idB < m_TableSize)
+		{
+			const Entry& entry = m_Table[idA * m_TableSize + idB];
+			if (entry.handler)
+			{
+				if (entry.swap)
+					entry.handler(b, a);
+				else
+					entry.handler(a, b);
+				return;
+			}
+		}
+
+		a.OnCollideEnter(b);
+		b.OnCollideEnter(a);
+	}
+
+	void ContactDispatcher::Dispatch()
+	{
+		RemoveDuplicates(m_Ends);
+		RemoveDuplicates(m_Begins);
+
+		for (const Event& event : m_Ends)
+		{
+			event.a->OnCollideExit(*event.b);
+			event.b->OnCollideExit(*event.a);
+		}
+
+		// Handlers may add objects or destroy them, destroyed objects stay valid until the delete pass
+		for (const Event& event : m_Begins)
+		{
+			Begin(*event.a, *event.b);
+		}
+
+		m_Begins.clear();
+		m_Ends.clear();
+	}
+
+}
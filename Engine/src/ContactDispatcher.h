@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+
+#include "GameObjects.h"
+
+namespace GameEngine {
+
+	// Collects the touches a tick produces from Box2D and the projectile grid, keeps one
+	// event per pair and notifies both objects of it. Pairs with a handler for their two
+	// groups go to the handler, looked up by the tag ids, the rest to OnCollideEnter.
+	class ContactDispatcher
+	{
+	public:
+		// a is always of the first group and b of the second group of SetHandler
+		typedef void (*Handler)(GameObject& a, GameObject& b);
+
+		// Replaces OnCollideEnter on both objects of a pair of these groups, null goes back to it
+		void SetHandler(Tag groupA, Tag groupB, Handler handler);
+
+		// Either order, a pair reported twice in one tick is still dispatched once
+		void AddBegin(GameObject& a, GameObject& b);
+		void AddEnd(GameObject& a, GameObject& b);
+
+		// Calls OnCollideExit for every ended pair, then the handlers for every new one, and empties the batch.
+		// Events keep the order they were added in.
+		void Dispatch();
+
+	private:
+		struct Event
+		{
+			GameObject* a;
+			GameObject* b;
+		};
+
+		// One table cell per ordered group pair, swap means the handler takes the objects the other way round
+		struct Entry
+		{
+			Handler handler = nullptr;
+			bool swap = false;
+		};
+
+		void RemoveDuplicates(std::vector<Event>& events);
+		void Begin(GameObject& a, GameObject& b);
+
+		std::vector<Entry> m_Table; // m_TableSize * m_TableSize
+		int m_TableSize = 0;
+
+		std::vector<Event> m_Begins;
+		std::vector<Event> m_Ends;
+		std::vector<Event> m_Keys;
+		std::vector<int> m_Order;
+		std::vector<bool> m_Keep;
+	};
+
+}
@@ -1,18 +1,27 @@
 #include "Engine.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
 
-#include <glm/glm.hpp>
-#include <glad/glad.h>
 #include <SDL.h>
 #include <box2d/box2d.h>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 #include <vector>
 
 
 #include "SDL_gamecontroller.h"
-#include "stb_image.h"
+#include "CollisionFilter.h"
+#include "ContactDispatcher.h"
+#include "GLRenderBackend.h"
+#include "JobSystem.h"
+#include "MoverSystem.h"
+#include "NullRenderBackend.h"
+#include "ObjectPool.h"
+#include "ProjectileCollision.h"
+#include "SoftwareRenderBackend.h"
+#include "RenderQueue.h"
+#include "TextureCache.h"
 
 
 //SDL_Renderer* SDL_CreateRenderer(SDL_Window* window, int index, Uint32 flags);
@@ -46,7 +55,7 @@ SDL_Window* window = nullptr;
 //box2d setup
 b2Vec2 gravity = { 0.0f, 0.0f };
 b2WorldDef worldDef = b2DefaultWorldDef();
-b2WorldId worldId = b2CreateWorld(&worldDef);
+b2WorldId worldId = b2_nullWorldId;
 
 float timeStep = 1.0f / 60.0f;
 int subStepCount = 2;
@@ -130,469 +139,589 @@ bool Input::IsGamepadButtonPressed(GamepadButton button, bool singleClick) {
 
 namespace GameEngine {
 
-	GLuint m_Texture;
-	GLuint m_vbo;
-	GLuint m_vao;
-	GLuint m_ebo;
-	GLuint m_ShaderProgram;
-	glm::vec2 m_Scale2D = glm::vec2(1.f, 1.f);
-	glm::vec3 m_Position2D = glm::vec3(0.0f, 0.0f, 1.f);
+	RenderQueue renderQueue;
+	TextureCache textureCache;
+	CollisionFilter collisionFilter;
+	ContactDispatcher contactDispatcher;
+	EntityRegistry entities;
+	EntityWorld entityWorld;
+	ProjectileCollision projectileCollision;
+	JobSystem physicsJobs;
+	MoverSystem moverSystem;
+	// Frame list of clips without manual frames, kept to register clips without allocating
+	std::vector<int> clipFrames;
+	// Objects the delete pass took out of the level this frame
+	std::vector<GameObject*> destroyedObjects;
+	// Level objects the tick calls OnUpdate on, every one but the movers without callUpdate
+	std::vector<GameObject*> tickedObjects;
+	// Entities whose Lifetime ran out this tick
+	std::vector<EntityHandle> expiredEntities;
+	// Draws of Sprite entities this frame, their render commands point here
+	std::vector<SpriteDraw> entitySprites;
+	static const std::uint32_t kEntitySpritePayload = 0x80000000u;
+
+	// The view in pixels around the origin, object positions are in the same units
+	static const float kViewHalfWidth = 320.f;
+	static const float kViewHalfHeight = 240.f;
+	// Object sizes map to clip space as size / kSpriteSizeScale on both axes
+	static const float kSpriteSizeScale = 250.f;
+
+	// Whether any part of the object's sprite can land inside the view
+	static bool IsOnScreen(const GameObject& obj)
+	{
+		float halfWidth = obj.collisionBoxSize.w / kSpriteSizeScale * 0.5f;
+		float halfHeight = obj.collisionBoxSize.h / kSpriteSizeScale * 0.5f;
 
-	unsigned int m_Indices[] = {  // note that we start from 0!
-					0, 1, 3,   // first triangle
-					1, 2, 3    // second triangle
-	};
+		// The instanced shader rotates in clip space, so a rotated sprite stays inside the circle around its corners
+		if (obj.rotation != 0.f)
+		{
+			halfWidth = halfHeight = std::sqrt(halfWidth * halfWidth + halfHeight * halfHeight);
+		}
 
-	float m_Vertices[] = {
-		// positions         // colors           // texture coords
-		0.5f,  0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   1.f, 1.f,   // top right
-		0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   1.f , 0.0f,   // bottom right
-	   -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   0.0f, 0.0f,   // bottom left
-	   -0.5f,  0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   0.0f, 1.f    // top left
-	};
+		// Back from clip space to pixels
+		halfWidth *= kViewHalfWidth;
+		halfHeight *= kViewHalfHeight;
 
+		return obj.position.x + halfWidth >= -kViewHalfWidth && obj.position.x - halfWidth <= kViewHalfWidth
+			&& obj.position.y + halfHeight >= -kViewHalfHeight && obj.position.y - halfHeight <= kViewHalfHeight;
+	}
 
-	void Engine::Update()
+	// Whether the clip just ended after steps frames: once after the last frame for a clip that
+	// does not loop, after every round for one that does. Every animation path counts steps and
+	// asks this, so OnAnimationFinish does not depend on the render or animation mode.
+	static bool ClipEnded(const Animation& animation, int steps, int clipLength)
 	{
-		int prevTime = 0;
-		int currentTime = 0;
-		bool isRunning = true;
-		SDL_Event event;
-		bool swap = false;
+		if (clipLength <= 0)
+			return false;
+		return animation.loop ? steps % clipLength == 0 : steps == clipLength;
+	}
 
-		while (isRunning) {
-			prevTime = currentTime;
-			currentTime = SDL_GetTicks();
-			deltaTime = (currentTime - prevTime) / 1000.0f;
+	// Describes a queued level object for the backend. alpha places it between its position
+	// before and after the last simulation tick.
+	static SpriteDraw MakeSpriteDraw(const GameObject& obj, bool gpuAnimation, float alpha)
+	{
+		float x = obj.previousPosition.x + (obj.position.x - obj.previousPosition.x) * alpha;
+		float y = obj.previousPosition.y + (obj.position.y - obj.previousPosition.y) * alpha;
+
+		SpriteDraw sprite;
+		sprite.texture = obj.m_Texture;
+		sprite.x = x / kViewHalfWidth;
+		sprite.y = y / kViewHalfHeight;
+		sprite.w = obj.collisionBoxSize.w / kSpriteSizeScale;
+		sprite.h = obj.collisionBoxSize.h / kSpriteSizeScale;
+		sprite.rotation = obj.rotation;
+		sprite.u0 = obj.m_Vertices[22];
+		sprite.v0 = obj.m_Vertices[23];
+		sprite.u1 = obj.m_Vertices[6];
+		sprite.v1 = obj.m_Vertices[7];
+		sprite.r = obj.modulate.r;
+		sprite.g = obj.modulate.g;
+		sprite.b = obj.modulate.b;
+
+		if (gpuAnimation && obj.isInit && obj.animationClip >= 0)
+		{
+			const Animation* spriteAnimation = obj.animation;
+			sprite.clip = obj.animationClip;
+			sprite.sheetColumns = spriteAnimation->tilemapSize.w;
+			sprite.sheetRows = spriteAnimation->tilemapSize.h;
+			sprite.startTime = obj.animationStartTime;
+			sprite.frameDuration = spriteAnimation->frameDuration;
+			sprite.loop = spriteAnimation->loop;
+		}
+		return sprite;
+	}
 
-			for (int i = 0; i < getLevel().background.size(); ++i)
-			{
-				getLevel().background[i]->OnUpdate();
+	static SpriteDraw MakeEntitySpriteDraw(const Transform& transform, const Sprite& sprite, float alpha)
+	{
+		float x = transform.previousX + (transform.x - transform.previousX) * alpha;
+		float y = transform.previousY + (transform.y - transform.previousY) * alpha;
+
+		SpriteDraw draw;
+		draw.texture = sprite.texture;
+		draw.x = x / kViewHalfWidth;
+		draw.y = y / kViewHalfHeight;
+		draw.w = sprite.w / kSpriteSizeScale;
+		draw.h = sprite.h / kSpriteSizeScale;
+		draw.rotation = transform.rotation;
+		draw.u0 = sprite.u0;
+		draw.v0 = sprite.v0;
+		draw.u1 = sprite.u1;
+		draw.v1 = sprite.v1;
+		draw.r = sprite.r;
+		draw.g = sprite.g;
+		draw.b = sprite.b;
+		return draw;
+	}
 
+	// Built-in systems of the EntityWorld, run at the start of every tick
+	static void UpdateEntities(float timeStep)
+	{
+		entityWorld.EachChunk<Transform>([](int count, EntityHandle*, Transform* transforms) {
+			for (int i = 0; i < count; ++i)
+			{
+				transforms[i].previousX = transforms[i].x;
+				transforms[i].previousY = transforms[i].y;
 			}
+		});
 
+		entityWorld.EachChunk<Transform, Velocity>([timeStep](int count, EntityHandle*, Transform* transforms, Velocity* velocities) {
+			for (int i = 0; i < count; ++i)
+			{
+				transforms[i].x += velocities[i].x * timeStep;
+				transforms[i].y += velocities[i].y * timeStep;
+			}
+		});
 
-			glClearColor(0.0f, 1.0f, 1.0f, 1.0f); // Cyan Blue
-
-			glClear(GL_COLOR_BUFFER_BIT);
-
-			//Multiple background layers
-			for (auto i = getLevel().background.begin(); i != getLevel().background.end(); ++i)
+		expiredEntities.clear();
+		entityWorld.EachChunk<Lifetime>([timeStep](int count, EntityHandle* entities, Lifetime* lifetimes) {
+			for (int i = 0; i < count; ++i)
 			{
-				if (!(*i)->isTiled)
-				{
-					if (!(*i)->isInit)
-					{
-						std::cout << "shader program is null\n" << std::endl;
+				lifetimes[i].seconds -= timeStep;
+				if (lifetimes[i].seconds <= 0.f)
+					expiredEntities.push_back(entities[i]);
+			}
+		});
 
-						glGenBuffers(1, &(*i)->m_vbo); // Generate 1 buffer
+		// Legacy objects go through their own delete pass, which removes their entity as well
+		for (EntityHandle entity : expiredEntities)
+		{
+			LegacyObject* legacy = entityWorld.Get<LegacyObject>(entity);
+			if (legacy != nullptr)
+				legacy->object->Destroy();
+			else
+				entityWorld.Destroy(entity);
+		}
+	}
 
-						glGenBuffers(1, &(*i)->m_ebo);
+	static void CopyLegacyState(const GameObject& obj, Transform& transform, Collider& collider)
+	{
+		transform.x = obj.position.x;
+		transform.y = obj.position.y;
+		transform.previousX = obj.previousPosition.x;
+		transform.previousY = obj.previousPosition.y;
+		transform.rotation = obj.rotation;
+
+		collider.w = obj.collisionBoxSize.w;
+		collider.h = obj.collisionBoxSize.h;
+		collider.group = obj.objectGroup;
+	}
 
-						glGenVertexArrays(1, &(*i)->m_vao);
+	// Creates the entity standing in for a level object as it joins. Its Transform and Collider
+	// are only copied again by syncLegacyEntities, no built-in system reads them.
+	static void CreateLegacyEntity(GameObject& obj)
+	{
+		Transform transform;
+		Collider collider;
+		CopyLegacyState(obj, transform, collider);
 
-						// 1. bind Vertex Array Object
-						glBindVertexArray((*i)->m_vao);
+		LegacyObject legacy;
+		legacy.object = &obj;
+		obj.entity = entityWorld.Create(transform, collider, legacy);
+	}
 
-						// 2. copy our vertices array in a buffer for OpenGL to use
-						glBindBuffer(GL_ARRAY_BUFFER, (*i)->m_vbo);
-						glBufferData(GL_ARRAY_BUFFER, sizeof(m_Vertices), m_Vertices, GL_STATIC_DRAW);
+	// Box2D hands its parallel-for tasks to the engine job system
+	static void* EnqueuePhysicsTask(b2TaskCallback* task, int32_t itemCount, int32_t minRange, void* taskContext, void* userContext)
+	{
+		return static_cast<JobSystem*>(userContext)->Submit(task, itemCount, minRange, taskContext);
+	}
 
-						glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, (*i)->m_ebo);
-						glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m_Indices), m_Indices, GL_STATIC_DRAW);
+	static void FinishPhysicsTask(void* userTask, void* userContext)
+	{
+		static_cast<JobSystem*>(userContext)->Wait(static_cast<JobSystem::Job*>(userTask));
+	}
 
-						// Vertex Shader
+	static void CreatePhysicsWorld(int workers)
+	{
+		worldDef.gravity = gravity;
+		// Bodies are placed by game code every frame, a sleeping body would stop reporting contacts
+		worldDef.enableSleep = false;
 
-						const char* vertexShaderSource = R"glsl(
-				#version 330 core
+		physicsJobs.Start(workers);
+		if (physicsJobs.GetWorkerCount() > 1)
+		{
+			worldDef.workerCount = physicsJobs.GetWorkerCount();
+			worldDef.enqueueTask = EnqueuePhysicsTask;
+			worldDef.finishTask = FinishPhysicsTask;
+			worldDef.userTaskContext = &physicsJobs;
+		}
+		else
+		{
+			worldDef.workerCount = 1;
+			worldDef.enqueueTask = nullptr;
+			worldDef.finishTask = nullptr;
+			worldDef.userTaskContext = nullptr;
+		}
 
-				in vec3 position;
-				in vec3 color;
-				in vec2 texCoord;
+		worldId = b2CreateWorld(&worldDef);
+		b2World_EnableContinuous(worldId, true);
+	}
 
-				out vec3 Color;
-				out vec2 TexCoord;
+	// The world takes every remaining body with it, objects get a new one on their next tick
+	static void DestroyPhysicsWorld(GameLevel& level)
+	{
+		b2DestroyWorld(worldId);
+		worldId = b2_nullWorldId;
+		for (GameObject* obj : level.levelObjects)
+		{
+			obj->bodyHandle = 0;
+		}
+		physicsJobs.Stop();
+	}
 
-				uniform mat4 model;
+	// Bodies live as long as their object. Box2D only reports contacts here, so the body is
+	// a box over the collision size with its corner on the object position.
+	// Overlap mode uses a kinematic body, which never gets contact constraints, with a sensor
+	// that reports what touches the object and a second shape that other sensors can see.
+	static void CreateBody(GameObject& obj, CollisionMode mode)
+	{
+		bool overlap = mode == CollisionMode::Overlap;
+
+		float bodyWidth = obj.collisionBoxSize.w / 2.0f;
+		float bodyHeight = obj.collisionBoxSize.h / 2.0f;
+
+		b2BodyDef bodyDef = b2DefaultBodyDef();
+		bodyDef.type = overlap ? b2_kinematicBody : b2_dynamicBody;
+		bodyDef.position = { obj.position.x, obj.position.y };
+		// Shapes carry the handle, so events resolve through the registry and never to a removed object
+		void* userData = (void*)(std::uintptr_t)obj.handle.GetBits();
+		bodyDef.userData = userData;
+		b2BodyId bodyId = b2CreateBody(worldId, &bodyDef);
+
+		b2Vec2 bodyCenter{ bodyWidth, bodyHeight };
+		b2Polygon box = b2MakeOffsetBox(bodyWidth, bodyHeight, bodyCenter, b2Rot_identity);
+
+		b2ShapeDef shapeDef = b2DefaultShapeDef();
+		shapeDef.density = 1.0f;
+		shapeDef.friction = 0.3f;
+		shapeDef.userData = userData;
+		shapeDef.filter.categoryBits = collisionFilter.GetCategory(obj.objectGroup);
+		shapeDef.filter.maskBits = collisionFilter.GetMask(obj.objectGroup);
+
+		if (overlap)
+		{
+			shapeDef.isSensor = true;
+			shapeDef.enableContactEvents = false;
+			b2CreatePolygonShape(bodyId, &shapeDef, &box);
 
-				void main()
-				{
-					Color = color;
-					TexCoord = texCoord;
-					gl_Position = model * vec4(position, 1.0);
-				}
-			)glsl";
+			shapeDef.isSensor = false;
+			shapeDef.enableSensorEvents = true;
+			b2CreatePolygonShape(bodyId, &shapeDef, &box);
+		}
+		else
+		{
+			shapeDef.enableContactEvents = true;
+			shapeDef.enableSensorEvents = false;
+			b2CreatePolygonShape(bodyId, &shapeDef, &box);
+		}
 
-						GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-						glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-						glCompileShader(vertexShader);
+		obj.bodyHandle = b2StoreBodyId(bodyId);
+	}
 
-						GLint  success;
-						//char infoLog[512];
-						glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+	// Gives the shapes of an existing body the current filter of its group
+	static void RefreshBodyFilter(GameObject& obj)
+	{
+		b2BodyId bodyId = b2LoadBodyId(obj.bodyHandle);
 
-						// Fragment Shader
+		b2Filter filter = b2DefaultFilter();
+		filter.categoryBits = collisionFilter.GetCategory(obj.objectGroup);
+		filter.maskBits = collisionFilter.GetMask(obj.objectGroup);
 
-						const char* fragmentShaderSource = R"glsl(
-				#version 330 core
-				in vec3 Color;
-				in vec2 TexCoord;
+		std::vector<b2ShapeId> shapes(b2Body_GetShapeCount(bodyId));
+		b2Body_GetShapes(bodyId, shapes.data(), (int)shapes.size());
+		for (b2ShapeId shapeId : shapes)
+		{
+			b2Shape_SetFilter(shapeId, filter);
+		}
+	}
 
-				out vec4 outColor;
+	// Game code moves objects by position, so the body follows it and whatever the solver
+	// did to resolve the last contacts is dropped
+	static void SyncBody(const GameObject& obj)
+	{
+		b2BodyId bodyId = b2LoadBodyId(obj.bodyHandle);
+		b2Body_SetTransform(bodyId, { obj.position.x, obj.position.y }, b2Rot_identity);
+		b2Body_SetLinearVelocity(bodyId, b2Vec2_zero);
+		b2Body_SetAngularVelocity(bodyId, 0.0f);
+	}
 
-				uniform sampler2D ourTexture;
+	// Moves every mover, then keeps its body and projectile grid box in step straight from the mover
+	// arrays. Beyond WriteBack only the body handle is read from the objects.
+	static void UpdateMovers(float timeStep, bool projectiles, CollisionMode mode)
+	{
+		moverSystem.Integrate(timeStep);
+		moverSystem.WriteBack(timeStep);
 
-				void main()
+		int count = moverSystem.GetCount();
+		for (int i = 0; i < count; ++i)
+		{
+			const MoverSystem::Contact& contact = moverSystem.GetContact(i);
+			GameObject& obj = moverSystem.GetObject(i);
+			if (moverSystem.IsDestroyed(i))
+			{
+				if (obj.bodyHandle != 0)
 				{
-					vec4 colTex1 = texture(ourTexture, TexCoord);
-					if(colTex1 == vec4(1, 0, 1, 1)) discard;
-
-					outColor = colTex1;
-				})glsl";
-
-						GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-						glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-						glCompileShader(fragmentShader);
+					b2DestroyBody(b2LoadBodyId(obj.bodyHandle));
+					obj.bodyHandle = 0;
+				}
+				continue;
+			}
 
-						glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+			float x = moverSystem.GetX(i);
+			float y = moverSystem.GetY(i);
+			if (projectiles && contact.inGrid)
+			{
+				projectileCollision.Add(obj, x, y, contact.width, contact.height,
+					contact.projectile, contact.category, contact.mask);
+			}
+			// A new physics world took the old body, WriteBack already put the object where it starts
+			if (contact.body && obj.bodyHandle == 0)
+			{
+				CreateBody(obj, mode);
+			}
+			else if (obj.bodyHandle != 0)
+			{
+				b2BodyId bodyId = b2LoadBodyId(obj.bodyHandle);
+				b2Body_SetTransform(bodyId, { x, y }, b2Rot_identity);
+				b2Body_SetLinearVelocity(bodyId, b2Vec2_zero);
+				b2Body_SetAngularVelocity(bodyId, 0.0f);
+			}
+		}
+	}
 
-						if (!success)
-						{
-							//glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-							//std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-						}
+	// Hands an object that joined the level to the mover system, the update loop or both
+	static void JoinUpdate(GameObject& obj)
+	{
+		if (obj.mover.enabled)
+		{
+			MoverSystem::Contact contact;
+			contact.inGrid = projectileCollision.HasGroups() && obj.hasBox2d;
+			contact.projectile = contact.inGrid && projectileCollision.UsesGroup(obj.objectGroup);
+			contact.body = obj.bodyHandle != 0;
+			contact.category = collisionFilter.GetCategory(obj.objectGroup);
+			contact.mask = collisionFilter.GetMask(obj.objectGroup);
+			contact.width = obj.collisionBoxSize.w;
+			contact.height = obj.collisionBoxSize.h;
+			moverSystem.Add(obj, contact);
+			if (!obj.mover.callUpdate)
+				return;
+		}
+		tickedObjects.push_back(&obj);
+	}
 
-						(*i)->m_ShaderProgram = glCreateProgram();
+	void Engine::Update()
+	{
+		int prevTime = 0;
+		int currentTime = 0;
+		int frameCount = 0;
+		int goldenMismatches = 0;
+		SDL_Event event;
+		bool swap = false;
 
-						glAttachShader((*i)->m_ShaderProgram, vertexShader);
-						glAttachShader((*i)->m_ShaderProgram, fragmentShader);
-						glLinkProgram((*i)->m_ShaderProgram);
+		isRunning = true;
+		while (isRunning) {
+			Uint64 frameStart = SDL_GetPerformanceCounter();
+			renderStats = RenderStats();
 
-						glDeleteShader(vertexShader);
-						glDeleteShader(fragmentShader);
+			prevTime = currentTime;
+			currentTime = SDL_GetTicks();
+			float frameTime = (currentTime - prevTime) / 1000.0f;
 
-						glGetProgramiv(m_ShaderProgram, GL_LINK_STATUS, &success);
-						if (!success) {
-							//glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-							//std::cout << "ERROR::SHADER::PROGRAM::COMPILATION_FAILED\n" << infoLog << std::endl;
-						}
+			// Headless frames take no real time worth measuring, every frame is exactly one tick instead
+			if (headless)
+			{
+				frameTime = timeStep;
+			}
 
-						// 3. then set our vertex attributes pointers
-						GLint posAttrib = glGetAttribLocation((*i)->m_ShaderProgram, "position");
-						glEnableVertexAttribArray(posAttrib);
-						glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+			for (int i = 0; i < getLevel().background.size(); ++i)
+			{
+				getLevel().background[i]->OnUpdate();
 
-						GLint colorAttrib = glGetAttribLocation((*i)->m_ShaderProgram, "color");
-						glEnableVertexAttribArray(colorAttrib);
-						glVertexAttribPointer(colorAttrib, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+			}
 
-						GLint texCoordAttrib = glGetAttribLocation((*i)->m_ShaderProgram, "texCoord");
-						glEnableVertexAttribArray(texCoordAttrib);
-						glVertexAttribPointer(texCoordAttrib, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+			// Objects and physics advance in fixed ticks, so gameplay does not depend on the frame rate.
+			// A slow frame catches up with at most maxSimulationSteps ticks and drops the rest.
+			Uint64 physicsStart = SDL_GetPerformanceCounter();
+			simulationAccumulator += frameTime;
+			deltaTime = timeStep;
+			int simulationSteps = 0;
+			bool projectiles = projectileCollision.HasGroups();
+			// Objects added outside a tick, by main or the draw pass, join before the first one
+			flushSpawns();
+			while (simulationAccumulator >= timeStep && simulationSteps < maxSimulationSteps)
+			{
+				Uint64 entityStart = SDL_GetPerformanceCounter();
+				UpdateEntities(timeStep);
+				renderStats.entityUpdateMs += (SDL_GetPerformanceCounter() - entityStart) * 1000.0f / SDL_GetPerformanceFrequency();
 
-						glGenTextures(1, &(*i)->m_Texture);
-						glBindTexture(GL_TEXTURE_2D, (*i)->m_Texture);
+				if (projectiles)
+					projectileCollision.Begin();
 
+				Uint64 moverStart = SDL_GetPerformanceCounter();
+				UpdateMovers(timeStep, projectiles, collisionMode);
+				renderStats.moverUpdateMs += (SDL_GetPerformanceCounter() - moverStart) * 1000.0f / SDL_GetPerformanceFrequency();
 
-						// set the texture wrapping/filtering options (on the currently bound texture object)
-						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+				for (size_t i = 0; i < tickedObjects.size(); ++i) {
+					GameObject* obj = tickedObjects[i];
 
-						stbi_set_flip_vertically_on_load(true);
+					// Movers with callUpdate, UpdateMovers already moved them and handled their body and box
+					if (obj->moverIndex >= 0)
+					{
+						if (!obj->toBeDeleted)
+							obj->OnUpdate();
+						continue;
+					}
 
-						int width, height, nrChannels;
-						unsigned char* data = stbi_load((*i)->background_path.c_str(), &width, &height, &nrChannels, 0);
-						if (data)
-						{
-							glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-							glGenerateMipmap(GL_TEXTURE_2D);
-						}
-						else
+					// Destroyed objects wait for the delete pass, their body must not collide in the meantime
+					if (obj->toBeDeleted)
+					{
+						if (obj->bodyHandle != 0)
 						{
-							std::cout << "Failed to load texture" << (*i)->background_path << std::endl;
+							b2DestroyBody(b2LoadBodyId(obj->bodyHandle));
+							obj->bodyHandle = 0;
 						}
-						stbi_image_free(data);
-
-						glUseProgram((*i)->m_ShaderProgram);
-
-						GLuint textureLocation;
-
-						textureLocation = glGetUniformLocation((*i)->m_ShaderProgram, "ourTexture");
-
-						glUniform1i(textureLocation, 0);
+						continue;
+					}
 
-						(*i)->isInit = true;
+					obj->previousPosition.x = obj->position.x;
+					obj->previousPosition.y = obj->position.y;
+					obj->OnUpdate();
 
+					// Projectile groups are tested by projectileCollision, against everything that has a body
+					bool projectile = projectiles && obj->hasBox2d && projectileCollision.UsesGroup(obj->objectGroup);
+					if (projectiles && obj->hasBox2d)
+					{
+						projectileCollision.Add(*obj, projectile,
+							collisionFilter.GetCategory(obj->objectGroup), collisionFilter.GetMask(obj->objectGroup));
 					}
 
-					if ((*i)->isInit)
+					// Spawners and other objects without hasBox2d never get a body
+					if (obj->hasBox2d && !projectile)
 					{
-						glUseProgram((*i)->m_ShaderProgram);
-
-						glm::mat4 model = glm::mat4(1.0f); // Identity matrix
-						model = glm::translate(model, glm::vec3((*i)->scrollRect.w, (*i)->scrollRect.h, 1.0f)); // Apply translation
-						model = glm::scale(model, glm::vec3((*i)->size.x, (*i)->size.y, 1.0f)); // Apply scaling
-
-						// Pass the model matrix to the shader
-						GLuint modelLoc = glGetUniformLocation((*i)->m_ShaderProgram, "model");
-						glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-
-						glBindVertexArray((*i)->m_vao);
-
-						glActiveTexture(GL_TEXTURE0);
-						glBindTexture(GL_TEXTURE_2D, (*i)->m_Texture);
-
-						glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
+						if (obj->bodyHandle == 0)
+							CreateBody(*obj, collisionMode);
+						else
+							SyncBody(*obj);
 					}
-				}
-				else
-				{
-					if (!(*i)->isInit)
+					else if (obj->bodyHandle != 0)
 					{
-						std::cout << "Initialize tiled background" << std::endl;
-
-						float tempVertices[] = {
-							// positions         // colors           // texture coords
-							0.5f,  0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   1.f / ((float)(*i)->tileMapSize.columns),  1.f,   // top right
-							0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   1.f / ((float)(*i)->tileMapSize.columns),  1.f - (1.f / ((float)(*i)->tileMapSize.rows)),   // bottom right
-						   -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   0.0f,											1.f - (1.f / ((float)(*i)->tileMapSize.rows)),   // bottom left
-						   -0.5f,  0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   0.0f,											1.f    // top left
-						};
-
-						std::copy(std::begin(tempVertices), std::end(tempVertices), std::begin((*i)->tiledVertices));
-
-						// Initialize tiled background
-						glGenBuffers(1, &(*i)->m_vbo); // Generate 1 buffer
-						glGenBuffers(1, &(*i)->m_ebo);
-						glGenVertexArrays(1, &(*i)->m_vao);
-
-						// 1. bind Vertex Array Object
-						glBindVertexArray((*i)->m_vao);
-
-						// 2. copy our vertices array in a buffer for OpenGL to use
-						glBindBuffer(GL_ARRAY_BUFFER, (*i)->m_vbo);
-						glBufferData(GL_ARRAY_BUFFER, sizeof((*i)->tiledVertices), (*i)->tiledVertices, GL_STATIC_DRAW);
-
-						glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, (*i)->m_ebo);
-						glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m_Indices), m_Indices, GL_STATIC_DRAW);
-
-						// Vertex Shader
-						const char* vertexShaderSource = R"glsl(
-                    #version 330 core
-                    in vec3 position;
-                    in vec3 color;
-                    in vec2 texCoord;
-                    out vec3 Color;
-                    out vec2 TexCoord;
-                    uniform mat4 model;
-                    void main()
-                    {
-                        Color = color;
-                        TexCoord = texCoord;
-                        gl_Position = model * vec4(position, 1.0);
-                    }
-                )glsl";
-
-						GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-						glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-						glCompileShader(vertexShader);
-
-						GLint success;
-						glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-
-						// Fragment Shader
-						const char* fragmentShaderSource = R"glsl(
-                    #version 330 core
-                    in vec3 Color;
-                    in vec2 TexCoord;
-                    out vec4 outColor;
-                    uniform sampler2D ourTexture;
-                    void main()
-                    {
-                        vec4 colTex1 = texture(ourTexture, TexCoord);
-                        if(colTex1 == vec4(1, 0, 1, 1)) discard;
-                        outColor = colTex1;
-                    }
-                )glsl";
-
-						GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-						glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-						glCompileShader(fragmentShader);
-
-						glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-
-						(*i)->m_ShaderProgram = glCreateProgram();
-						glAttachShader((*i)->m_ShaderProgram, vertexShader);
-						glAttachShader((*i)->m_ShaderProgram, fragmentShader);
-						glLinkProgram((*i)->m_ShaderProgram);
-
-						glDeleteShader(vertexShader);
-						glDeleteShader(fragmentShader);
-
-						glGetProgramiv(m_ShaderProgram, GL_LINK_STATUS, &success);
-
-						// 3. then set our vertex attributes pointers
-						GLint posAttrib = glGetAttribLocation((*i)->m_ShaderProgram, "position");
-						glEnableVertexAttribArray(posAttrib);
-						glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-
-						GLint colorAttrib = glGetAttribLocation((*i)->m_ShaderProgram, "color");
-						glEnableVertexAttribArray(colorAttrib);
-						glVertexAttribPointer(colorAttrib, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-
-						GLint texCoordAttrib = glGetAttribLocation((*i)->m_ShaderProgram, "texCoord");
-						glEnableVertexAttribArray(texCoordAttrib);
-						glVertexAttribPointer(texCoordAttrib, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-
-						glGenTextures(1, &(*i)->m_Texture);
-						glBindTexture(GL_TEXTURE_2D, (*i)->m_Texture);
-
-						// set the texture wrapping/filtering options (on the currently bound texture object)
-						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-						stbi_set_flip_vertically_on_load(true);
-
-						int width, height, nrChannels;
-						unsigned char* data = stbi_load((*i)->background_path.c_str(), &width, &height, &nrChannels, 0);
-						if (data)
-						{
-							glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-							glGenerateMipmap(GL_TEXTURE_2D);
-						}
-						else
-						{
-							std::cout << "Failed to load texture" << (*i)->background_path << std::endl;
-						}
-						stbi_image_free(data);
-
-						glUseProgram((*i)->m_ShaderProgram);
-
-						GLuint textureLocation;
-						textureLocation = glGetUniformLocation((*i)->m_ShaderProgram, "ourTexture");
-						glUniform1i(textureLocation, 0);
-
-						(*i)->isInit = true;
+						b2DestroyBody(b2LoadBodyId(obj->bodyHandle));
+						obj->bodyHandle = 0;
 					}
+				}
 
-					if ((*i)->isInit)
-					{
-						glUseProgram((*i)->m_ShaderProgram);
+				// One step for the whole level, after every object has moved
+				b2World_Step(worldId, timeStep, subStepCount);
+				renderStats.physicsSolveMs += b2World_GetProfile(worldId).solve;
+				contactListener();
+				sensorListener();
+				if (projectiles)
+					projectileCollision.Update(contactDispatcher);
+				contactDispatcher.Dispatch();
+				flushSpawns();
+
+				simulationAccumulator -= timeStep;
+				simulationSteps++;
+			}
+			if (simulationAccumulator >= timeStep)
+			{
+				simulationAccumulator = std::fmod(simulationAccumulator, timeStep);
+			}
+			interpolationAlpha = simulationAccumulator / timeStep;
+			renderStats.physicsSteps = simulationSteps;
+			renderStats.physicsTimeMs = (SDL_GetPerformanceCounter() - physicsStart) * 1000.0f / SDL_GetPerformanceFrequency();
 
-						for (int y = 0; y < (*i)->numTiles.y; ++y)
-						{
-							std::cout << "-----------------" << std::endl;
 
-							for (int x = 0; x < (*i)->numTiles.x; ++x)
-							{
-								int tileIndex = y * (*i)->numTiles.x + x;
-								//std::cout << "Tile Index: " << tileIndex << std::endl;
-								if (tileIndex >= (*i)->tileIDs.size())
-									continue;
-
-								int tileID = (*i)->tileIDs[tileIndex];
-								
-								int column = tileID % (*i)->tileMapSize.columns;
-								int row = tileID / (*i)->tileMapSize.columns;
-
-								std::cout << "Tile ID: " << tileID << std::endl;
-								std::cout << "Columns: " << column << std::endl;
-								std::cout << "Rows: " << row << std::endl;
-
-								float texWidth = 1.0f / (*i)->tileMapSize.columns;
-								float texHeight = 1.0f / (*i)->tileMapSize.rows;
-
-								float xTexCoord = column * texWidth;
-								float yTexCoord = 1.0f - ((row + 1) * texHeight);
-
-								// Update texture coordinates
-								(*i)->tiledVertices[6] = xTexCoord + texWidth;
-								(*i)->tiledVertices[7] = yTexCoord + texHeight; // Top right
-								(*i)->tiledVertices[14] = xTexCoord + texWidth;
-								(*i)->tiledVertices[15] = yTexCoord; // Bottom right
-								(*i)->tiledVertices[22] = xTexCoord;
-								(*i)->tiledVertices[23] = yTexCoord; // Bottom left
-								(*i)->tiledVertices[30] = xTexCoord;
-								(*i)->tiledVertices[31] = yTexCoord + texHeight; // Top left
-
-								// Update VBO with new texture coordinates
-								glBindBuffer(GL_ARRAY_BUFFER, (*i)->m_vbo);
-								glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof((*i)->tiledVertices), (*i)->tiledVertices);
-
-								glm::mat4 model = glm::mat4(1.0f); // Identity matrix
-								model = glm::translate(model, glm::vec3((*i)->scrollRect.w + x * (*i)->size.x, (*i)->scrollRect.h - y * (*i)->size.y, 1.0f)); // Apply translation
-								model = glm::scale(model, glm::vec3((*i)->size.x, (*i)->size.y, 1.0f)); // Apply scaling
-
-								// Pass the model matrix to the shader
-								GLuint modelLoc = glGetUniformLocation((*i)->m_ShaderProgram, "model");
-								glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-								glBindVertexArray((*i)->m_vao);
-								glActiveTexture(GL_TEXTURE0);
-								glBindTexture(GL_TEXTURE_2D, (*i)->m_Texture);
-								glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-							}
-						}
-					}
+			//Multiple background layers
+			renderQueue.Begin();
+			for (auto i = getLevel().background.begin(); i != getLevel().background.end(); ++i)
+			{
+				if (!(*i)->isInit)
+				{
+					(*i)->m_Texture = textureCache.Acquire((*i)->background_path);
+					renderBackend->CreateBackground(**i);
+
+					(*i)->isInit = true;
 				}
-				
+
+				// Backgrounds keep their list order through the depth bits
+				int layerIndex = (int)(i - getLevel().background.begin());
+				renderQueue.Push(RenderQueue::MakeKey((int)RenderLayer::Background, layerIndex, ShaderType::Background, (*i)->m_Texture),
+					(std::uint32_t)layerIndex);
 			}
 
 			// Delete GameObjects
+			// One stable pass moves the survivors together in their order, the destroyed objects
+			// are released as a batch afterwards. Objects destroyed by OnDestroyed go next frame.
+			std::vector<GameObject*>& levelObjects = getLevel().levelObjects;
+			destroyedObjects.clear();
+			size_t keptObjects = 0;
+			for (size_t i = 0; i < levelObjects.size(); ++i)
+			{
+				if (levelObjects[i]->toBeDeleted)
+					destroyedObjects.push_back(levelObjects[i]);
+				else
+					levelObjects[keptObjects++] = levelObjects[i];
+			}
+			levelObjects.resize(keptObjects);
 
-			for (int i = getLevel().levelObjects.size() - 1; i >= 0; --i) {
-				if (getLevel().levelObjects[i]->toBeDeleted == true) {
-					getLevel().levelObjects[i]->OnDestroyed();
-					if (getLevel().levelObjects[i]->animation->tilemapPath != "")
+			if (!destroyedObjects.empty())
+			{
+				tickedObjects.erase(std::remove_if(tickedObjects.begin(), tickedObjects.end(),
+					[](GameObject* obj) { return obj->toBeDeleted; }), tickedObjects.end());
+
+				for (GameObject* obj : destroyedObjects)
+				{
+					obj->OnDestroyed();
+				}
+
+				// Box2D recycles bodies in its own pools, so pooled objects get a new one on their next spawn
+				for (GameObject* obj : destroyedObjects)
+				{
+					if (obj->bodyHandle != 0)
 					{
-						glUseProgram(getLevel().levelObjects[i]->m_ShaderProgram);
-						glBindVertexArray(0);
-						glBindBuffer(GL_ARRAY_BUFFER, 0);
-						glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-						glActiveTexture(GL_TEXTURE0);
-						glDeleteProgram(getLevel().levelObjects[i]->m_ShaderProgram);
+						b2DestroyBody(b2LoadBodyId(obj->bodyHandle));
+						obj->bodyHandle = 0;
 					}
+					entities.Remove(obj->handle);
+					obj->handle = EntityHandle();
+					entityWorld.Destroy(obj->entity);
+					obj->entity = EntityHandle();
+				}
+				projectileCollision.ForgetDestroyed();
+				moverSystem.ForgetDestroyed();
 
-					if (getLevel().levelObjects[i]->bodyId != nullptr)
+				// Pooled objects keep their texture reference and animation for the next spawn
+				for (GameObject* obj : destroyedObjects)
+				{
+					if (obj->pool != nullptr)
 					{
-						b2DestroyBody(*getLevel().levelObjects[i]->bodyId);
+						obj->pool->Recycle(obj);
 					}
 					else
 					{
-						std::cout << "Object with no body" << i << std::endl;
+						textureCache.Release(obj->m_Texture);
+						delete obj;
 					}
-					delete getLevel().levelObjects[i];
-					getLevel().levelObjects.erase(getLevel().levelObjects.begin() + i);
-				}
-			}
-
-			for (int i = getLevel().levelObjects.size() - 1; i >= 0; --i)
-			{
-				auto obj = getLevel().levelObjects[i];
-				if (obj->bodyId != nullptr)
-				{
-					b2DestroyBody(*obj->bodyId);
-					delete obj->bodyDef;
-					delete obj->bodyId;
-					delete obj->boxCollision;
-					delete obj->shapeId;
-					delete obj->shapeDef;
 				}
 			}
 
 			//Create Objects
+			// GPU animation needs the instance data, the CPU batch only knows fixed UV rects
+			bool gpuAnimation = animationMode == AnimationMode::Gpu && renderMode == RenderMode::Instanced;
+			animationTime += frameTime;
+
 			for (auto i = getLevel().levelObjects.begin(); i != getLevel().levelObjects.end(); ++i)
 			{
 				if ((*i)->animation != nullptr)
 				{
 					if ((*i)->animation->tilemapPath != "")
 					{
+						bool onScreen = IsOnScreen(**i);
+						// A clip that does not loop ends in a few frames and objects like explosions wait for its
+						// OnAnimationFinish to go away, so it keeps playing outside the view in every mode
+						bool animate = onScreen || offscreenAnimation == OffscreenAnimation::Advance || !(*i)->animation->loop;
+						bool frozen = !animate && offscreenAnimation == OffscreenAnimation::Freeze;
+
 						//Initialize Object
 						if (!(*i)->isInit)
 						{
@@ -606,171 +735,92 @@ namespace GameEngine {
 
 							std::copy(std::begin(tempVertices), std::end(tempVertices), std::begin((*i)->m_Vertices));
 
-							glGenBuffers(1, &(*i)->m_vbo); // Generate 1 buffer
+							// Acquire before releasing so switching between clips of the same sheet keeps it resident
+							unsigned int previousTexture = (*i)->m_Texture;
+							(*i)->m_Texture = textureCache.Acquire((*i)->animation->tilemapPath);
+							textureCache.Release(previousTexture);
 
-							glGenBuffers(1, &(*i)->m_ebo);
-
-							glGenVertexArrays(1, &(*i)->m_vao);
-
-							// 1. bind Vertex Array Object
-							glBindVertexArray((*i)->m_vao);
-
-							// 2. copy our vertices array in a buffer for OpenGL to use
-							glBindBuffer(GL_ARRAY_BUFFER, (*i)->m_vbo);
-							glBufferData(GL_ARRAY_BUFFER, sizeof((*i)->m_Vertices), (*i)->m_Vertices, GL_STATIC_DRAW);
-
-							glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, (*i)->m_ebo);
-							glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m_Indices), m_Indices, GL_STATIC_DRAW);
-
-
-
-							// Vertex Shader
-
-							const char* vertexShaderSource = R"glsl(
-				#version 330 core
-
-				in vec3 position;
-				in vec3 color;
-				in vec2 texCoord;
-
-				out vec3 Color;
-				out vec2 TexCoord;
-
-				uniform mat4 model;
-
-				void main()
-				{
-					Color = color;
-					TexCoord = texCoord;
-					gl_Position = model * vec4(position, 1.0);
-				}
-			)glsl";
-
-							GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-							glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-							glCompileShader(vertexShader);
-
-							GLint  success;
-							//char infoLog[512];
-							glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-
-							// Fragment Shader
-
-							const char* fragmentShaderSource = R"glsl(
-				#version 330 core
-				in vec3 Color;
-				in vec2 TexCoord;
-
-				out vec4 outColor;
-
-				uniform sampler2D ourTexture;
-
-				void main()
-				{
-					vec4 colTex1 = texture(ourTexture, TexCoord);
-					if(colTex1 == vec4(1, 0, 1, 1)) discard;
-
-					outColor = colTex1;
-				})glsl";
-
-							GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-							glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-							glCompileShader(fragmentShader);
-
-							glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-
-							if (!success)
+							if (gpuAnimation)
 							{
-								//glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-								//std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-							}
-
-							(*i)->m_ShaderProgram = glCreateProgram();
-
-							glAttachShader((*i)->m_ShaderProgram, vertexShader);
-							glAttachShader((*i)->m_ShaderProgram, fragmentShader);
-							glLinkProgram((*i)->m_ShaderProgram);
-
-							glDeleteShader(vertexShader);
-							glDeleteShader(fragmentShader);
-
-							glGetProgramiv(m_ShaderProgram, GL_LINK_STATUS, &success);
-							if (!success) {
-								//glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-								//std::cout << "ERROR::SHADER::PROGRAM::COMPILATION_FAILED\n" << infoLog << std::endl;
+								Animation* spriteAnimation = (*i)->animation;
+								const std::vector<int>* frames = &spriteAnimation->manual;
+								if (frames->empty())
+								{
+									// Reused between objects, so respawning a pooled object does not allocate
+									clipFrames.clear();
+									for (int frame = 0; frame < spriteAnimation->tilemapSize.w * spriteAnimation->tilemapSize.h; ++frame)
+									{
+										clipFrames.push_back(frame);
+									}
+									frames = &clipFrames;
+								}
+								(*i)->animationClip = renderBackend->RegisterClip(*frames);
+								(*i)->animationStartTime = animationTime;
+								(*i)->elapsedTime = 0.f;
 							}
 
-							// 3. then set our vertex attributes pointers
-							GLint posAttrib = glGetAttribLocation((*i)->m_ShaderProgram, "position");
-							glEnableVertexAttribArray(posAttrib);
-							glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-
-							GLint colorAttrib = glGetAttribLocation((*i)->m_ShaderProgram, "color");
-							glEnableVertexAttribArray(colorAttrib);
-							glVertexAttribPointer(colorAttrib, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-
-							GLint texCoordAttrib = glGetAttribLocation((*i)->m_ShaderProgram, "texCoord");
-							glEnableVertexAttribArray(texCoordAttrib);
-							glVertexAttribPointer(texCoordAttrib, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-
-							glGenTextures(1, &(*i)->m_Texture);
-							glBindTexture(GL_TEXTURE_2D, (*i)->m_Texture);
-
+							(*i)->animationSteps = 0;
+							(*i)->isInit = true;
 
-							// set the texture wrapping/filtering options (on the currently bound texture object)
-							glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-							glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-							glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-							glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+						}
 
-							stbi_set_flip_vertically_on_load(true);
+						//Update Object
+						if ((*i)->isInit && gpuAnimation)
+						{
+							// The shader picks the frame, the CPU only counts frames to raise OnAnimationFinish at the end of the clip
+							Animation* spriteAnimation = (*i)->animation;
+							int clipLength = renderBackend->GetClipLength((*i)->animationClip);
 
-							int width, height, nrChannels;
-							unsigned char* data = stbi_load((*i)->animation->tilemapPath.c_str(), &width, &height, &nrChannels, 0);
-							if (data)
+							// A frozen clip starts later by the time it spent frozen, so it resumes on the same frame
+							if (frozen)
 							{
-								glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-								glGenerateMipmap(GL_TEXTURE_2D);
+								(*i)->animationStartTime += frameTime;
 							}
 							else
 							{
-								std::cout << "Failed to load object texture" << std::endl;
+								(*i)->elapsedTime += frameTime;
 							}
-							stbi_image_free(data);
-
-							glUseProgram((*i)->m_ShaderProgram);
-
-							GLuint textureLocation;
-
-							textureLocation = glGetUniformLocation((*i)->m_ShaderProgram, "ourTexture");
 
-							glUniform1i(textureLocation, 0);
+							while (animate && clipLength > 0 && (*i)->elapsedTime >= spriteAnimation->frameDuration)
+							{
+								(*i)->elapsedTime -= spriteAnimation->frameDuration;
+								(*i)->animationSteps++;
 
-							(*i)->isInit = true;
+								if (ClipEnded(*spriteAnimation, (*i)->animationSteps, clipLength))
+								{
+									(*i)->OnAnimationFinish();
 
+									// The object switched to another clip, it restarts once it is initialized again
+									if (!(*i)->isInit || (*i)->animation != spriteAnimation)
+										break;
+								}
+							}
 						}
-
-						//Update Object
-						if ((*i)->isInit)
+						else if ((*i)->isInit && !frozen)
 						{
 							Animation* spriteAnimation = (*i)->animation;
-							glUseProgram((*i)->m_ShaderProgram);
-							if (spriteAnimation->tilemapPath != "") {
+							if (!animate)
+							{
+								// Lazy, the frames are caught up once the object is back in view
+								(*i)->elapsedTime += frameTime;
+							}
+							else if (spriteAnimation->tilemapPath != "") {
 
 								if (spriteAnimation->manual.empty() == true)
 								{
 									// Increment elapsed time
-									(*i)->elapsedTime += deltaTime;
+									(*i)->elapsedTime += frameTime;
 
-									// Check if enough time has passed to advance to the next frame
-									if ((*i)->elapsedTime >= spriteAnimation->frameDuration) {
+									// Advance as many frames as have passed, more than one after a slow frame or a lazy catch up
+									while ((*i)->elapsedTime >= spriteAnimation->frameDuration) {
 										// Subtract frameTime to preserve leftover time
 										(*i)->elapsedTime -= spriteAnimation->frameDuration;
 
 										// Advance to the next frame in the animation
-										int frameCount = (spriteAnimation->tilemapSize.w * spriteAnimation->tilemapSize.h - 1) + 1;
+										int frameCount = spriteAnimation->tilemapSize.w * spriteAnimation->tilemapSize.h;
 										spriteAnimation->currentFrame =
 											((spriteAnimation->currentFrame + 1) % frameCount);
+										(*i)->animationSteps++;
 
 										// Calculate texture coordinates for the current frame
 										int column = spriteAnimation->currentFrame % spriteAnimation->tilemapSize.w;
@@ -788,39 +838,41 @@ namespace GameEngine {
 										(*i)->m_Vertices[22] = x;            (*i)->m_Vertices[23] = y;           // Bottom left
 										(*i)->m_Vertices[30] = x;            (*i)->m_Vertices[31] = y + texHeight; // Top left
 
-										if (spriteAnimation->currentFrame == spriteAnimation->tilemapSize.h - 1)
+										if (ClipEnded(*spriteAnimation, (*i)->animationSteps, frameCount))
 										{
 											(*i)->OnAnimationFinish();
+											if (!(*i)->isInit || (*i)->animation != spriteAnimation)
+												break;
 										}
-
-										// Update VBO with new texture coordinates
-										glBindBuffer(GL_ARRAY_BUFFER, (*i)->m_vbo);
-										glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * 32, (*i)->m_Vertices);
 									}
 								}
-								if (spriteAnimation->manual.empty() == false)
+								else
 								{
 									// Increment elapsed time
-									(*i)->elapsedTime += deltaTime;
+									(*i)->elapsedTime += frameTime;
 
-									// Check if enough time has passed to advance to the next frame
-									if ((*i)->elapsedTime >= spriteAnimation->frameDuration) {
+									// Advance as many frames as have passed, more than one after a slow frame or a lazy catch up
+									while ((*i)->elapsedTime >= spriteAnimation->frameDuration) {
 										// Subtract frameTime to preserve leftover time
 										(*i)->elapsedTime -= spriteAnimation->frameDuration;
 
 										// Advance to the next frame in the animation
 										spriteAnimation->currentFrame = spriteAnimation->manual[spriteAnimation->targetFrame];
+										(*i)->animationSteps++;
 										if (spriteAnimation->targetFrame < (spriteAnimation->manual.size() - 1))
 										{
 											spriteAnimation->targetFrame++;
 										}
-										else
+										else if (spriteAnimation->loop)
+										{
+											spriteAnimation->targetFrame = 0;
+										}
+
+										if (ClipEnded(*spriteAnimation, (*i)->animationSteps, (int)spriteAnimation->manual.size()))
 										{
-											if (spriteAnimation->loop)
-											{
-												spriteAnimation->targetFrame = 0;
-											}
 											(*i)->OnAnimationFinish();
+											if (!(*i)->isInit || (*i)->animation != spriteAnimation)
+												break;
 										}
 										// Calculate texture coordinates for the current frame
 										int column = spriteAnimation->currentFrame % spriteAnimation->tilemapSize.w;
@@ -837,120 +889,131 @@ namespace GameEngine {
 										(*i)->m_Vertices[14] = x + texWidth; (*i)->m_Vertices[15] = y;           // Bottom right
 										(*i)->m_Vertices[22] = x;            (*i)->m_Vertices[23] = y;           // Bottom left
 										(*i)->m_Vertices[30] = x;            (*i)->m_Vertices[31] = y + texHeight; // Top left
-
-										// Update VBO with new texture coordinates
-										glBindBuffer(GL_ARRAY_BUFFER, (*i)->m_vbo);
-										glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * 32, (*i)->m_Vertices);
 									}
 								}
 
 							}
+						}
 
-
-
-							glm::mat4 model = glm::mat4(1.0f); // Identity matrix
-							model = glm::translate(model, glm::vec3((*i)->position.x / 320.f, (*i)->position.y / 240.f, 1.0f)); // Apply translation
-							model = glm::scale(model, glm::vec3((*i)->collisionBoxSize.w / 250.f, (*i)->collisionBoxSize.h / 250.f, 1.0f)); // Apply scaling
-
-							// Pass the model matrix to the shader
-							GLuint modelLoc = glGetUniformLocation((*i)->m_ShaderProgram, "model");
-							//GLint projectionLoc = glGetUniformLocation((*i)->m_ShaderProgram, "projection");
-							glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-
-							glBindVertexArray((*i)->m_vao);
-
-							glActiveTexture(GL_TEXTURE0);
-							glBindTexture(GL_TEXTURE_2D, (*i)->m_Texture);
-
-							glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-							glUseProgram(0);
+						// Queue the sprite, it is drawn once every command of the frame is sorted
+						if ((*i)->visible && !onScreen)
+						{
+							renderStats.culledSprites++;
+						}
+						else if ((*i)->visible)
+						{
+							ShaderType spriteShader = renderMode == RenderMode::Instanced ? ShaderType::InstancedSprite : ShaderType::Sprite;
+							renderQueue.Push(RenderQueue::MakeKey((int)(*i)->renderLayer, 0, spriteShader, (*i)->m_Texture),
+								(std::uint32_t)(i - getLevel().levelObjects.begin()));
 						}
 					}
 				}
 				
 			}
 
-			//Manage Created Objects
-			for (int i = 0; i < getLevel().levelObjects.size(); ++i) {
-				GameObject* obj = getLevel().levelObjects[i];
-
-				obj->OnUpdate();
-
-				Animation* spriteAnimation = obj->animation;
-
-
-				//THIS IS TO IGNORE SPAWNERS. THE FIRST TWO OBJECTS IN THE LEVEL OBJECTS VECTOR ARE SPAWNERS
-					//This is a just a workaround for now. I will implement a better way to handle this later, because i need to create
-					//a bool variable for objects for the user to want or not a box2d body but right now i dont have time for that.
-
-				if (getLevel().levelObjects[i]->hasBox2d)
+			// Sprite entities, their payload is an index into entitySprites with the top bit set
+			entitySprites.clear();
+			ShaderType entityShader = renderMode == RenderMode::Instanced ? ShaderType::InstancedSprite : ShaderType::Sprite;
+			entityWorld.EachChunk<Transform, Sprite>([&](int count, EntityHandle*, Transform* transforms, Sprite* sprites) {
+				for (int i = 0; i < count; ++i)
 				{
-					float bodyWidth;// = getLevel().levelObjects[i]->collisionBoxSize.w;
-					float bodyHeight;// = getLevel().levelObjects[i]->collisionBoxSize.h;
-					bodyWidth = getLevel().levelObjects[i]->collisionBoxSize.w / 2.0f;
-					bodyHeight = getLevel().levelObjects[i]->collisionBoxSize.h / 2.0f;
-
-
-					b2BodyDef* bodyDef = new b2BodyDef;
-					*bodyDef = b2DefaultBodyDef();
-					bodyDef->type = b2_dynamicBody;
-					bodyDef->position = { getLevel().levelObjects[i]->position.x, getLevel().levelObjects[i]->position.y };
-					//bodyDef-> = getLevel().levelObjects[i]->isBullet;
-					bodyDef->userData = getLevel().levelObjects[i];
-
-
-					b2BodyId* bodyId = new b2BodyId;
-					*bodyId = b2CreateBody(worldId, bodyDef);
-
-					b2Vec2 bodyCenter{ bodyWidth, bodyHeight };
-					float angle = 4.0f;
-
-					b2Polygon* dynamicBox = new b2Polygon;
-					//*dynamicBox = b2MakeBox(bodyWidth, bodyHeight);
-					*dynamicBox = b2MakeOffsetBox(bodyWidth, bodyHeight, bodyCenter, b2MakeRot(angle * b2_pi));
+					renderQueue.Push(RenderQueue::MakeKey((int)sprites[i].layer, 0, entityShader, sprites[i].texture),
+						kEntitySpritePayload | (std::uint32_t)entitySprites.size());
+					entitySprites.push_back(MakeEntitySpriteDraw(transforms[i], sprites[i], interpolationAlpha));
+				}
+			});
 
-					b2ShapeDef* shapeDef = new b2ShapeDef;
-					*shapeDef = b2DefaultShapeDef();
-					shapeDef->density = 1.0f;
-					shapeDef->friction = 0.3f;
+			// Walk the sorted commands, the backend keeps everything in this order
+			Uint64 sortStart = SDL_GetPerformanceCounter();
+			renderQueue.Sort();
+			Uint64 submitStart = SDL_GetPerformanceCounter();
 
-					//shapeDef->enableSensorEvents = getLevel().levelObjects[i]->hasSense;
+			renderBackend->BeginFrame(animationTime);
+			for (const RenderCommand& command : renderQueue.GetCommands())
+			{
+				ShaderType shader = RenderQueue::GetShader(command.key);
+				if (shader == ShaderType::Background)
+				{
+					renderBackend->DrawBackground(*getLevel().background[command.payload], renderStats);
+				}
+				else if (command.payload & kEntitySpritePayload)
+				{
+					renderBackend->DrawSprite(entitySprites[command.payload & ~kEntitySpritePayload], shader);
+				}
+				else
+				{
+					renderBackend->DrawSprite(MakeSpriteDraw(*getLevel().levelObjects[command.payload], gpuAnimation, interpolationAlpha), shader);
+				}
+			}
+			renderBackend->EndFrame(renderStats);
 
-					//shapeDef->enableSensorEvents = true;
-					//shapeDef->isSensor = getLevel().levelObjects[i]->hasSense;
+			renderStats.renderCommands = (int)renderQueue.GetCommands().size();
+			renderStats.sortTimeMs = (submitStart - sortStart) * 1000.0f / SDL_GetPerformanceFrequency();
+			renderStats.submitTimeMs = (SDL_GetPerformanceCounter() - submitStart) * 1000.0f / SDL_GetPerformanceFrequency();
 
-					//shapeDef->enableContactEvents = true;
+			while (SDL_PollEvent(&event) != 0) {
+				if (event.type == SDL_QUIT) {
+					isRunning = false;
+				}
+			}
 
-					shapeDef->userData = getLevel().levelObjects[i];
+			renderBackend->Present();
 
-					shapeDef->enableContactEvents = true;
+			renderStats.frameTimeMs = (SDL_GetPerformanceCounter() - frameStart) * 1000.0f / SDL_GetPerformanceFrequency();
+			renderStats.frame = frameCount + 1;
+			lastFrameStats = renderStats;
 
-					b2ShapeId* shapeId = new b2ShapeId;
-					*shapeId = b2CreatePolygonShape(*bodyId, shapeDef, dynamicBox);
+			// Frames are numbered from 0, so a capture run and a golden run line up frame by frame
+			if (!captureDirectory.empty() || !goldenDirectory.empty())
+			{
+				char frameName[32];
+				snprintf(frameName, sizeof(frameName), "frame_%05d.bmp", frameCount);
 
-					getLevel().levelObjects[i]->bodyId = bodyId;
-					getLevel().levelObjects[i]->bodyDef = bodyDef;
-					getLevel().levelObjects[i]->shapeId = shapeId;
-					getLevel().levelObjects[i]->shapeDef = shapeDef;
-					getLevel().levelObjects[i]->boxCollision = dynamicBox;
+				if (!captureDirectory.empty() && !renderBackend->SaveFrame(captureDirectory + "/" + frameName))
+				{
+					std::cout << "Failed to capture " << frameName << std::endl;
 				}
-
-
-				b2World_Step(worldId, timeStep, subStepCount);
-				contactListener();
-
-				while (SDL_PollEvent(&event) != 0) {
-					if (event.type == SDL_QUIT) {
-						isRunning = false;
+				if (!goldenDirectory.empty())
+				{
+					int differences = renderBackend->CompareFrame(goldenDirectory + "/" + frameName);
+					if (differences != 0)
+					{
+						goldenMismatches++;
+						if (differences < 0)
+							std::cout << "Could not compare " << frameName << " against the golden frame" << std::endl;
+						else
+							std::cout << frameName << " differs from the golden frame in " << differences << " pixels" << std::endl;
 					}
 				}
 			}
 
-			SDL_GL_SwapWindow(window);
+			frameCount++;
+			if (frameLimit > 0 && frameCount >= frameLimit)
+			{
+				isRunning = false;
+			}
 		}
-			SDL_DestroyWindow(window);
+			if (!goldenDirectory.empty())
+			{
+				std::cout << "Golden frames: " << frameCount - goldenMismatches << " of " << frameCount << " match" << std::endl;
+			}
+			for (LevelBackground* layer : getLevel().background)
+			{
+				if (layer != nullptr && layer->isInit)
+				{
+					renderBackend->DestroyBackground(*layer);
+					layer->isInit = false;
+				}
+			}
+			textureCache.Clear();
+			textureCache.SetBackend(nullptr);
+			renderBackend->Shutdown();
+			delete renderBackend;
+			renderBackend = nullptr;
+			if (window != nullptr)
+			{
+				SDL_DestroyWindow(window);
+			}
 			//SDL_DestroyRenderer(renderTarget);
 
 			window = nullptr;
@@ -958,8 +1021,7 @@ namespace GameEngine {
 			background = nullptr;
 			renderTarget = nullptr;
 
-			b2DestroyWorld(worldId);
-			worldId = b2_nullWorldId;
+			DestroyPhysicsWorld(getLevel());
 
 			SDL_Quit();
 		
@@ -967,62 +1029,74 @@ namespace GameEngine {
 
 	void Engine::Initialize(GameWindow windowSettings)
 	{
-		//Set Gravity
-		worldDef.gravity = gravity;
+		CreatePhysicsWorld(physicsWorkers);
 
 
 		windowDisplay = windowSettings;
 		SDL_GameController* controller;
 		int i;
 
-		SDL_Init(SDL_INIT_VIDEO );
+		// Headless runs have no window, so only the event and timer parts of SDL are needed
+		if (headless)
+		{
+			SDL_Init(SDL_INIT_EVENTS | SDL_INIT_TIMER);
+			window = nullptr;
+			if (softwareRendering)
+			{
+				renderBackend = new SoftwareRenderBackend(nullptr, windowSettings.windowWidth, windowSettings.windowHeight);
+			}
+			else
+			{
+				renderBackend = new NullRenderBackend();
+			}
+		}
+		else
+		{
+			SDL_Init(SDL_INIT_VIDEO );
 
-		SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER);
+			SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER);
 		
-		for (i = 0; i < SDL_NumJoysticks(); ++i) {
-			if (SDL_IsGameController(i)) {
-				char* mapping;
-				std::cout << "Index '" << i << "' is a compatible controller, named '" << SDL_GameControllerNameForIndex(i) << "'" << std::endl;
-				controller = SDL_GameControllerOpen(i);
-				input.setGameController(controller);
-				mapping = SDL_GameControllerMapping(controller);
-				std::cout << "Controller " << i << " is mapped as \"" << mapping << std::endl;
-				SDL_free(mapping);
+			for (i = 0; i < SDL_NumJoysticks(); ++i) {
+				if (SDL_IsGameController(i)) {
+					char* mapping;
+					std::cout << "Index '" << i << "' is a compatible controller, named '" << SDL_GameControllerNameForIndex(i) << "'" << std::endl;
+					controller = SDL_GameControllerOpen(i);
+					input.setGameController(controller);
+					mapping = SDL_GameControllerMapping(controller);
+					std::cout << "Controller " << i << " is mapped as \"" << mapping << std::endl;
+					SDL_free(mapping);
+				}
+				else {
+					std::cout << "Index '" << i << "' is not a compatible controller." << std::endl;
+				}
 			}
-			else {
-				std::cout << "Index '" << i << "' is not a compatible controller." << std::endl;
+			window = SDL_CreateWindow(windowSettings.windowName, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowSettings.windowWidth, windowSettings.windowHeight, softwareRendering ? 0 : SDL_WINDOW_OPENGL);
+			//renderTarget = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+
+			if (softwareRendering)
+			{
+				renderBackend = new SoftwareRenderBackend(window, windowSettings.windowWidth, windowSettings.windowHeight);
+			}
+			else
+			{
+				renderBackend = new GLRenderBackend(window);
 			}
-		}
-		window = SDL_CreateWindow(windowSettings.windowName, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowSettings.windowWidth, windowSettings.windowHeight, SDL_WINDOW_OPENGL);
-		//renderTarget = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
-		SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
-
-		// Create an OpenGL context
-		SDL_GLContext m_Context = SDL_GL_CreateContext(window);
-		if (!m_Context) {
-			std::cout << "Failed to create OpenGL context" << std::endl;
-			SDL_DestroyWindow(window);
-			SDL_Quit();
-			return;
 		}
 
-		// Load OpenGL functions with GLAD
-		if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
-			// Print GLAD initialization log
-			int error;
-			glGetIntegerv(GL_MAJOR_VERSION, &error);
-			std::cout << "Failed to initialize GLAD: " << error << std::endl;
+		if (!renderBackend->Init())
+		{
+			std::cout << "Failed to initialize the render backend" << std::endl;
+			delete renderBackend;
+			renderBackend = nullptr;
+			if (window != nullptr)
+			{
+				SDL_DestroyWindow(window);
+			}
+			DestroyPhysicsWorld(getLevel());
 			SDL_Quit();
+			return;
 		}
-		//glEnable(GL_DEPTH_TEST);
-
-		SDL_GL_MakeCurrent(window, m_Context);
-
-		b2World_EnableContinuous(worldId, true);
+		textureCache.SetBackend(renderBackend);
 
 		//Init("resources/graphics/galaxy2.bmp");
 		//updateActor();
@@ -1033,6 +1107,11 @@ namespace GameEngine {
 	void Engine::setLevel(GameLevel level)
 	{
 		mainLevel = level;
+		projectileCollision.Clear();
+		moverSystem.Clear();
+		tickedObjects.clear();
+		for (GameObject* obj : getLevel().levelObjects)
+			JoinUpdate(*obj);
 	}
 
 	void Engine::print(std::string printText)
@@ -1040,11 +1119,197 @@ namespace GameEngine {
 		std::cout << printText << std::endl;
 	}
 
+	GameObject* Engine::getObject(EntityHandle handle) const
+	{
+		return entities.Get(handle);
+	}
+
+	EntityWorld& Engine::getWorld()
+	{
+		return entityWorld;
+	}
+
+	void Engine::syncLegacyEntities()
+	{
+		entityWorld.EachChunk<Transform, Collider, LegacyObject>([](int count, EntityHandle*, Transform* transforms, Collider* colliders, LegacyObject* legacy) {
+			for (int i = 0; i < count; ++i)
+				CopyLegacyState(*legacy[i].object, transforms[i], colliders[i]);
+		});
+	}
+
+	unsigned int Engine::acquireTexture(const std::string& path)
+	{
+		return textureCache.Acquire(path);
+	}
+
 	GameLevel& Engine::getLevel()
 	{
 		return mainLevel;
 	}
 
+	const RenderStats& Engine::getRenderStats() const
+	{
+		return lastFrameStats;
+	}
+
+	const TextureCache::Stats& Engine::getTextureCacheStats() const
+	{
+		return textureCache.GetStats();
+	}
+
+	void Engine::setRenderMode(RenderMode mode)
+	{
+		renderMode = mode;
+	}
+
+	void Engine::setAnimationMode(AnimationMode mode)
+	{
+		animationMode = mode;
+	}
+
+	void Engine::setOffscreenAnimation(OffscreenAnimation mode)
+	{
+		offscreenAnimation = mode;
+	}
+
+	void Engine::setHeadless(bool enabled)
+	{
+		headless = enabled;
+	}
+
+	void Engine::setFrameLimit(int frames)
+	{
+		frameLimit = frames;
+	}
+
+	void Engine::setSoftwareRendering(bool enabled)
+	{
+		softwareRendering = enabled;
+	}
+
+	void Engine::setFrameCapture(const std::string& directory)
+	{
+		captureDirectory = directory;
+	}
+
+	void Engine::setGoldenFrames(const std::string& directory)
+	{
+		goldenDirectory = directory;
+	}
+
+	void Engine::setMaxSimulationSteps(int steps)
+	{
+		maxSimulationSteps = steps > 0 ? steps : 1;
+	}
+
+	void Engine::setGroupsCollide(Tag groupA, Tag groupB, bool collide)
+	{
+		collisionFilter.SetCollides(groupA, groupB, collide);
+		refreshCollisionFilters();
+	}
+
+	void Engine::setGroupCollidesWithAll(Tag group, bool collide)
+	{
+		collisionFilter.SetCollidesWithAll(group, collide);
+		refreshCollisionFilters();
+	}
+
+	void Engine::setCollisionHandler(Tag groupA, Tag groupB, ContactDispatcher::Handler handler)
+	{
+		contactDispatcher.SetHandler(groupA, groupB, handler);
+	}
+
+	void Engine::setProjectileGroup(Tag group, bool enabled)
+	{
+		projectileCollision.SetGroup(group, enabled);
+	}
+
+	// The matrix is usually set up before any body exists, this only matters for changes during play
+	void Engine::refreshCollisionFilters()
+	{
+		for (GameObject* obj : getLevel().levelObjects)
+		{
+			if (obj->bodyHandle != 0)
+			{
+				RefreshBodyFilter(*obj);
+			}
+		}
+
+		int movers = moverSystem.GetCount();
+		for (int i = 0; i < movers; ++i)
+		{
+			Tag group = moverSystem.GetObject(i).objectGroup;
+			MoverSystem::Contact& contact = moverSystem.GetContact(i);
+			contact.category = collisionFilter.GetCategory(group);
+			contact.mask = collisionFilter.GetMask(group);
+		}
+	}
+
+	void Engine::setCollisionMode(CollisionMode mode)
+	{
+		collisionMode = mode;
+	}
+
+	void Engine::quit()
+	{
+		isRunning = false;
+	}
+
+	void Engine::setPhysicsWorkers(int workers)
+	{
+		physicsWorkers = workers > 0 ? workers : 1;
+		if (B2_IS_NON_NULL(worldId))
+		{
+			DestroyPhysicsWorld(getLevel());
+			CreatePhysicsWorld(physicsWorkers);
+		}
+	}
+
+	// Nothing is added to levelObjects while the tick walks it. Objects join in the order they were
+	// added, get OnStart, and those that collide get their body here rather than after their first update.
+	void Engine::flushSpawns()
+	{
+		GameLevel& level = getLevel();
+		if (level.pendingObjects.empty())
+			return;
+
+		// OnStart may add more objects, they join in the same flush
+		for (size_t i = 0; i < level.pendingObjects.size(); ++i)
+		{
+			GameObject* obj = level.pendingObjects[i];
+			obj->OnStart();
+
+			// Nothing to interpolate from before the first tick
+			obj->previousPosition.x = obj->position.x;
+			obj->previousPosition.y = obj->position.y;
+			CreateLegacyEntity(*obj);
+		}
+
+		// One insert grows the vector at most once for the whole batch
+		level.levelObjects.insert(level.levelObjects.end(), level.pendingObjects.begin(), level.pendingObjects.end());
+
+		bool projectiles = projectileCollision.HasGroups();
+		for (GameObject* obj : level.pendingObjects)
+		{
+			bool projectile = projectiles && projectileCollision.UsesGroup(obj->objectGroup);
+			if (obj->hasBox2d && !projectile && !obj->toBeDeleted && obj->bodyHandle == 0)
+				CreateBody(*obj, collisionMode);
+			JoinUpdate(*obj);
+		}
+
+		level.pendingObjects.clear();
+	}
+
+	// Game object behind a shape from an event, null once the shape is gone
+	static GameObject* GetShapeObject(b2ShapeId shapeId)
+	{
+		if (!b2Shape_IsValid(shapeId))
+			return nullptr;
+		return entities.Get(EntityHandle::FromBits((std::uint32_t)(std::uintptr_t)b2Shape_GetUserData(shapeId)));
+	}
+
+	// Overlap mode, every object has both shapes, so a pair shows up once from each side's
+	// sensor. The dispatcher keeps one of them.
 	void Engine::sensorListener()
 	{
 		b2SensorEvents sensorEvents = b2World_GetSensorEvents(worldId);
@@ -1052,23 +1317,22 @@ namespace GameEngine {
 		for (int i = 0; i < sensorEvents.beginCount; ++i)
 		{
 			b2SensorBeginTouchEvent* beginTouch = sensorEvents.beginEvents + i;
-			void* myUserData = b2Shape_GetUserData(beginTouch->visitorShapeId);
-			if (myUserData)
+			GameObject* sensor = GetShapeObject(beginTouch->sensorShapeId);
+			GameObject* visitor = GetShapeObject(beginTouch->visitorShapeId);
+			if (sensor && visitor)
 			{
-				GameObject* m = static_cast<GameObject*>(myUserData);
-
-				void* myUserData2 = b2Shape_GetUserData(beginTouch->sensorShapeId);
-				std::cout << "Sensor detected collision with object group: " << m->objectGroup << std::endl;
+				contactDispatcher.AddBegin(*sensor, *visitor);
+			}
+		}
 
-				if (myUserData2)
-				{
-					GameObject* m2 = static_cast<GameObject*>(myUserData2);
-					m->OnCollideEnter(*m2);
-					if (m2->objectGroup == "player")
-					{
-						std::cout << "Sensor detected collision with object group: " << m2->objectGroup << std::endl;
-					}
-				}
+		for (int i = 0; i < sensorEvents.endCount; ++i)
+		{
+			b2SensorEndTouchEvent* endTouch = sensorEvents.endEvents + i;
+			GameObject* sensor = GetShapeObject(endTouch->sensorShapeId);
+			GameObject* visitor = GetShapeObject(endTouch->visitorShapeId);
+			if (sensor && visitor)
+			{
+				contactDispatcher.AddEnd(*sensor, *visitor);
 			}
 		}
 	}
@@ -1076,27 +1340,27 @@ namespace GameEngine {
 	void Engine::contactListener() {
 		b2ContactEvents contactEvents = b2World_GetContactEvents(worldId);
 
-		if (contactEvents.beginCount > 0) {
-			//std::cout << "Contact Events Begin Count: " << contactEvents.beginCount << std::endl;
-		}
-
+		// Both objects of a touch are notified, not just the owner of shape A
 		for (int i = 0; i < contactEvents.beginCount; ++i)
 		{
 			b2ContactBeginTouchEvent* beginTouch = contactEvents.beginEvents + i;
-			void* myUserData = b2Shape_GetUserData(beginTouch->shapeIdA);
-			if (myUserData)
+			GameObject* m = GetShapeObject(beginTouch->shapeIdA);
+			GameObject* m2 = GetShapeObject(beginTouch->shapeIdB);
+			if (m && m2)
 			{
-				GameObject* m = static_cast<GameObject*>(myUserData);
-				//std::cout << m->objectGroup << std::endl;
-				void* myUserData2 = b2Shape_GetUserData(beginTouch->shapeIdB);
-				//std::cout << "Collision A: " << m->objectGroup << " " << m->collisionBoxSize.w << " " << m->collisionBoxSize.h;
-				
-				if (myUserData2)
-				{
-					GameObject* m2 = static_cast<GameObject*>(myUserData2);
-					m->OnCollideEnter(*m2);
-					//std::cout << " Collision B: " << m2->objectGroup << " " << m2->collisionBoxSize.w << " " << m2->collisionBoxSize.h << std::endl;
-				}
+				contactDispatcher.AddBegin(*m, *m2);
+			}
+		}
+
+		// End events can name shapes destroyed since the touch began
+		for (int i = 0; i < contactEvents.endCount; ++i)
+		{
+			b2ContactEndTouchEvent* endTouch = contactEvents.endEvents + i;
+			GameObject* m = GetShapeObject(endTouch->shapeIdA);
+			GameObject* m2 = GetShapeObject(endTouch->shapeIdB);
+			if (m && m2)
+			{
+				contactDispatcher.AddEnd(*m, *m2);
 			}
 		}
 	}
@@ -1122,12 +1386,14 @@ void GameLevel::setLayerSize(int layerSize)
 void GameObject::Destroy()
 {
 	toBeDeleted = true;
+	if (moverIndex >= 0)
+		GameEngine::moverSystem.MarkDestroyed(moverIndex);
 }
 
 void GameLevel::addObject(GameObject* obj)
 {
-	levelObjects.push_back(obj);
-	obj->OnStart();
+	pendingObjects.push_back(obj);
+	obj->handle = GameEngine::entities.Add(obj);
 }
 
 int Animation::GetSpriteWidth()
@@ -8,7 +8,12 @@
 
 #include "Animator.h"
 #include "GameLevel.h"
+#include "Components.h"
+#include "ContactDispatcher.h"
+#include "EntityWorld.h"
 #include "GameObjects.h"
+#include "RenderStats.h"
+#include "TextureCache.h"
 
 
 typedef int SDL_Keycode;
@@ -92,13 +97,98 @@ public:
 };
 
 namespace GameEngine {
+	class RenderBackend;
+
+	// Batched builds every quad on the CPU, Instanced draws one shared quad per sprite
+	// and also applies GameObject::rotation and GameObject::modulate
+	enum class RenderMode
+	{
+		Batched,
+		Instanced
+	};
+
+	// Cpu steps every sprite's UVs each frame. Gpu hands the clip to the instanced shader
+	// and only keeps a frame counter for OnAnimationFinish, it falls back to Cpu in Batched mode.
+	enum class AnimationMode
+	{
+		Cpu,
+		Gpu
+	};
+
+	// What happens to the animation of objects outside the view. Advance steps it as usual,
+	// Freeze holds it until the object comes back and Lazy lets time pass but only catches up
+	// the frames, and OnAnimationFinish, once the object is visible again. Clips that do not loop
+	// always advance, so their OnAnimationFinish comes on time wherever the object is.
+	enum class OffscreenAnimation
+	{
+		Advance,
+		Freeze,
+		Lazy
+	};
+
+	// Dynamic gives every body mass and lets the solver separate touching objects, which
+	// the engine then undoes because objects are moved by OnUpdate. Overlap only tests for
+	// overlaps through sensors. Both objects of a pair get OnCollideEnter and OnCollideExit either way.
+	enum class CollisionMode
+	{
+		Dynamic,
+		Overlap
+	};
+
 	class Engine
 	{
 	public:
+		// Seconds simulated by the current OnUpdate call, always one fixed tick
 		float deltaTime = 0.0f;
 
 		void setLevel(GameLevel level);
 		GameLevel& getLevel();
+		// The object behind handle, null once it was removed from the level
+		GameObject* getObject(EntityHandle handle) const;
+		template <class T>
+		T* getObjectAs(EntityHandle handle) const { return static_cast<T*>(getObject(handle)); }
+		// Entities made of components, updated by the built-in systems every tick and drawn if they have a Sprite
+		EntityWorld& getWorld();
+		// Copies position, rotation and collision box of every level object into its entity. Entities
+		// of level objects get them when they join and only here after that, call it before a query reads them.
+		void syncLegacyEntities();
+		// Texture for Sprite components, loaded once and kept until the game ends. Call once the engine runs.
+		unsigned int acquireTexture(const std::string& path);
+		const RenderStats& getRenderStats() const;
+		const TextureCache::Stats& getTextureCacheStats() const;
+		void setRenderMode(RenderMode mode);
+		void setAnimationMode(AnimationMode mode);
+		void setOffscreenAnimation(OffscreenAnimation mode);
+		// Headless runs the whole game without a window or GL context, call before Initialize
+		void setHeadless(bool enabled);
+		// Stops the game loop after this many frames, 0 runs until the window is closed
+		void setFrameLimit(int frames);
+		// Rasterizes on the CPU instead of OpenGL, in a window or headless. Call before Initialize.
+		void setSoftwareRendering(bool enabled);
+		// Writes every frame as frame_NNNNN.bmp into directory, needs software rendering
+		void setFrameCapture(const std::string& directory);
+		// Compares every frame against frame_NNNNN.bmp in directory and reports the ones that differ
+		void setGoldenFrames(const std::string& directory);
+		// Call before Initialize, bodies keep the mode they were created with
+		void setCollisionMode(CollisionMode mode);
+		// Lets objects of the two groups collide or pass through each other, pairs that pass never
+		// reach the narrowphase or OnCollideEnter. Every group collides with every group by default.
+		void setGroupsCollide(Tag groupA, Tag groupB, bool collide);
+		// Switches all pairs of group at once, usually followed by setGroupsCollide for the few that matter
+		void setGroupCollidesWithAll(Tag group, bool collide);
+		// Touches between objects of the two groups call handler(objectOfGroupA, objectOfGroupB) once
+		// instead of OnCollideEnter on both objects, whichever object the touch named first
+		void setCollisionHandler(Tag groupA, Tag groupB, ContactDispatcher::Handler handler);
+		// Objects of group skip Box2D and are tested with a grid of plain boxes, meant for the many
+		// small bullets of a shooter. They follow the same group matrix, handlers and callbacks.
+		void setProjectileGroup(Tag group, bool enabled);
+		// Threads Box2D steps the world with, counting the game thread. Changing it after Initialize
+		// rebuilds the world, every object gets a fresh body and new OnCollideEnter calls.
+		void setPhysicsWorkers(int workers);
+		// Ticks a slow frame may run to catch up, the rest of its time is dropped
+		void setMaxSimulationSteps(int steps);
+		// Leaves the game loop at the end of the current frame
+		void quit();
 		void print(std::string printText);
 
 		void Init(const std::string& path);
@@ -110,9 +200,29 @@ namespace GameEngine {
 	private:
 		void sensorListener();
 		void contactListener();
+		void refreshCollisionFilters();
+		void flushSpawns();
 
 		GameLevel mainLevel;
 		GameWindow windowDisplay;
+		RenderStats renderStats;
+		RenderStats lastFrameStats;
+		RenderMode renderMode = RenderMode::Batched;
+		AnimationMode animationMode = AnimationMode::Cpu;
+		OffscreenAnimation offscreenAnimation = OffscreenAnimation::Advance;
+		float animationTime = 0.0f;
+		CollisionMode collisionMode = CollisionMode::Dynamic;
+		float simulationAccumulator = 0.0f;
+		float interpolationAlpha = 0.0f;
+		int maxSimulationSteps = 5;
+		int physicsWorkers = 1;
+		RenderBackend* renderBackend = nullptr;
+		bool headless = false;
+		bool softwareRendering = false;
+		std::string captureDirectory;
+		std::string goldenDirectory;
+		int frameLimit = 0;
+		bool isRunning = false;
 		int prevTime = currentTime;
 		int currentTime = 0;
 
@@ -0,0 +1,26 @@
+#include "EntityRegistry.h"
+
+#include <iostream>
+
+namespace GameEngine {
+
+	EntityHandle EntityRegistry::Add(GameObject* obj)
+	{
+		EntityHandle handle = m_Slots.Allocate(obj);
+		if (handle.IsNull())
+			std::cout << "EntityRegistry: more than " << EntityHandle::kIndexMask << " objects, the new one gets no handle" << std::endl;
+		return handle;
+	}
+
+	void EntityRegistry::Remove(EntityHandle handle)
+	{
+		m_Slots.Free(handle);
+	}
+
+	void EntityRegistry::Relocate(EntityHandle handle, GameObject* obj)
+	{
+		if (GameObject** object = m_Slots.Get(handle))
+			*object = obj;
+	}
+
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class GameObject;
+
+namespace GameEngine {
+
+	// Names a game object without pointing at it. The low 22 bits are a slot index and the high
+	// 10 bits count how often that slot was reused, so a handle to a removed object stops resolving
+	// instead of dangling. Fits the 32 bit userData of Box2D on every platform. 0 is never handed out.
+	class EntityHandle
+	{
+	public:
+		static const int kIndexBits = 22;
+		static const std::uint32_t kIndexMask = (1u << kIndexBits) - 1;
+		static const std::uint32_t kGenerationMask = (1u << (32 - kIndexBits)) - 1;
+
+		EntityHandle() {}
+		EntityHandle(std::uint32_t index, std::uint32_t generation)
+			: m_Bits(generation << kIndexBits | index) {}
+
+		static EntityHandle FromBits(std::uint32_t bits)
+		{
+			EntityHandle handle;
+			handle.m_Bits = bits;
+			return handle;
+		}
+
+		std::uint32_t GetIndex() const { return m_Bits & kIndexMask; }
+		std::uint32_t GetGeneration() const { return m_Bits >> kIndexBits; }
+		std::uint32_t GetBits() const { return m_Bits; }
+		bool IsNull() const { return m_Bits == 0; }
+
+		bool operator==(EntityHandle other) const { return m_Bits == other.m_Bits; }
+		bool operator!=(EntityHandle other) const { return m_Bits != other.m_Bits; }
+
+	private:
+		std::uint32_t m_Bits = 0;
+	};
+
+	// Generational slots behind handles, holding one T each. Freeing a slot counts its generation
+	// up, so every handle to it stops resolving right away. Free slots are reused oldest first, so a
+	// stale handle only matches again after its slot went through 1024 values while every other free
+	// slot did too. Used by EntityRegistry for objects and by EntityWorld for entity rows.
+	template <class T>
+	class HandleSlots
+	{
+	public:
+		// Null once every index is in use
+		EntityHandle Allocate(const T& value)
+		{
+			std::uint32_t index;
+			if (m_FirstFree != kNoSlot)
+			{
+				index = m_FirstFree;
+				m_FirstFree = m_Slots[index].nextFree;
+				if (m_FirstFree == kNoSlot)
+					m_LastFree = kNoSlot;
+			}
+			else
+			{
+				if (m_Slots.size() > EntityHandle::kIndexMask)
+					return EntityHandle();
+				index = (std::uint32_t)m_Slots.size();
+				m_Slots.push_back(Slot());
+			}
+
+			Slot& slot = m_Slots[index];
+			slot.value = value;
+			slot.nextFree = kNoSlot;
+			m_Count++;
+			return EntityHandle(index, slot.generation);
+		}
+
+		// Stale or null handles are ignored
+		void Free(EntityHandle handle)
+		{
+			if (Get(handle) == nullptr)
+				return;
+
+			std::uint32_t index = handle.GetIndex();
+			Slot& slot = m_Slots[index];
+			slot.value = T();
+			// Generation 0 is left out, so no live handle is ever 0
+			slot.generation = (slot.generation + 1) & EntityHandle::kGenerationMask;
+			if (slot.generation == 0)
+				slot.generation = 1;
+
+			if (m_LastFree != kNoSlot)
+				m_Slots[m_LastFree].nextFree = index;
+			else
+				m_FirstFree = index;
+			m_LastFree = index;
+			m_Count--;
+		}
+
+		// Null if the handle is stale
+		T* Get(EntityHandle handle)
+		{
+			std::uint32_t index = handle.GetIndex();
+			if (index >= m_Slots.size() || m_Slots[index].generation != handle.GetGeneration())
+				return nullptr;
+			return &m_Slots[index].value;
+		}
+
+		const T* Get(EntityHandle handle) const
+		{
+			return const_cast<HandleSlots*>(this)->Get(handle);
+		}
+
+		int GetCount() const { return m_Count; }
+
+	private:
+		static const std::uint32_t kNoSlot = ~0u;
+
+		struct Slot
+		{
+			T value = T();
+			std::uint32_t generation = 1;
+			std::uint32_t nextFree = kNoSlot;
+		};
+
+		std::vector<Slot> m_Slots;
+		std::uint32_t m_FirstFree = kNoSlot;
+		std::uint32_t m_LastFree = kNoSlot;
+		int m_Count = 0;
+	};
+
+	// Slot map from handles to the objects of the running game. Lookups are one array access and a
+	// generation compare.
+	class EntityRegistry
+	{
+	public:
+		EntityHandle Add(GameObject* obj);
+		// The handle and every copy of it resolve to null afterwards
+		void Remove(EntityHandle handle);
+		// Points the handle at obj's new address, for storage that moves its objects
+		void Relocate(EntityHandle handle, GameObject* obj);
+
+		GameObject* Get(EntityHandle handle) const
+		{
+			GameObject* const* object = m_Slots.Get(handle);
+			return object != nullptr ? *object : nullptr;
+		}
+
+		bool IsAlive(EntityHandle handle) const { return Get(handle) != nullptr; }
+		int GetCount() const { return m_Slots.GetCount(); }
+
+	private:
+		HandleSlots<GameObject*> m_Slots;
+	};
+
+}
@@ -0,0 +1,199 @@
+#include "EntityWorld.h"
+
+#include <iostream>
+
+namespace GameEngine {
+
+	// Sizes by component id, ids are handed out in the order types are first used
+	static std::vector<int>& ComponentSizes()
+	{
+		static std::vector<int> sizes;
+		return sizes;
+	}
+
+	int ComponentTypes::Register(int size, int alignment)
+	{
+		std::vector<int>& sizes = ComponentSizes();
+		if ((int)sizes.size() >= kMaxComponents)
+		{
+			std::cout << "ComponentTypes: more than " << kMaxComponents << " component types" << std::endl;
+			return kMaxComponents - 1;
+		}
+		if (alignment > 16)
+		{
+			std::cout << "ComponentTypes: components are only aligned to 16 bytes" << std::endl;
+		}
+
+		sizes.push_back(size);
+		return (int)sizes.size() - 1;
+	}
+
+	int ComponentTypes::GetSize(int id)
+	{
+		return ComponentSizes()[id];
+	}
+
+	void EntityWorld::Destroy(EntityHandle entity)
+	{
+		const Location* location = m_Slots.Get(entity);
+		if (location == nullptr)
+			return;
+
+		RemoveRow(location->archetype, location->row);
+		m_Slots.Free(entity);
+	}
+
+	bool EntityWorld::IsAlive(EntityHandle entity) const
+	{
+		return m_Slots.Get(entity) != nullptr;
+	}
+
+	void EntityWorld::Clear()
+	{
+		// Chunks stay allocated for the entities that come next
+		for (int archetype = 0; archetype < (int)m_Archetypes.size(); ++archetype)
+		{
+			for (int row = 0; row < m_Archetypes[archetype].count; ++row)
+				m_Slots.Free(GetEntity(archetype, row));
+			m_Archetypes[archetype].count = 0;
+		}
+	}
+
+	int EntityWorld::FindArchetype(std::uint32_t signature)
+	{
+		auto found = m_ArchetypeBySignature.find(signature);
+		if (found != m_ArchetypeBySignature.end())
+			return found->second;
+
+		Archetype archetype;
+		archetype.signature = signature;
+		archetype.offsets.fill(-1);
+		archetype.sizes.fill(0);
+		archetype.addTargets.fill(-1);
+		archetype.removeTargets.fill(-1);
+
+		int rowBytes = (int)sizeof(EntityHandle);
+		int arrays = 1;
+		for (int id = 0; id < ComponentTypes::kMaxComponents; ++id)
+		{
+			if (signature & (1u << id))
+			{
+				archetype.sizes[id] = ComponentTypes::GetSize(id);
+				rowBytes += archetype.sizes[id];
+				arrays++;
+			}
+		}
+
+		// Every array may need up to kArrayAlignment bytes of padding in front of it
+		archetype.chunkBytes = (std::max)(kChunkBytes, rowBytes + arrays * kArrayAlignment);
+		archetype.chunkCapacity = (archetype.chunkBytes - arrays * kArrayAlignment) / rowBytes;
+
+		int offset = archetype.chunkCapacity * (int)sizeof(EntityHandle);
+		for (int id = 0; id < ComponentTypes::kMaxComponents; ++id)
+		{
+			if (signature & (1u << id))
+			{
+				offset = (offset + kArrayAlignment - 1) / kArrayAlignment * kArrayAlignment;
+				archetype.offsets[id] = offset;
+				offset += archetype.chunkCapacity * archetype.sizes[id];
+			}
+		}
+
+		m_Archetypes.push_back(std::move(archetype));
+		int index = (int)m_Archetypes.size() - 1;
+		m_ArchetypeBySignature[signature] = index;
+		return index;
+	}
+
+	int EntityWorld::GetAddTarget(int archetype, int id)
+	{
+		int target = m_Archetypes[archetype].addTargets[id];
+		if (target < 0)
+		{
+			target = FindArchetype(m_Archetypes[archetype].signature | (1u << id));
+			m_Archetypes[archetype].addTargets[id] = target;
+		}
+		return target;
+	}
+
+	int EntityWorld::GetRemoveTarget(int archetype, int id)
+	{
+		int target = m_Archetypes[archetype].removeTargets[id];
+		if (target < 0)
+		{
+			target = FindArchetype(m_Archetypes[archetype].signature & ~(1u << id));
+			m_Archetypes[archetype].removeTargets[id] = target;
+		}
+		return target;
+	}
+
+	EntityHandle EntityWorld::AllocateHandle(int archetype)
+	{
+		Location location;
+		location.archetype = archetype;
+		EntityHandle entity = m_Slots.Allocate(location);
+		if (entity.IsNull())
+			std::cout << "EntityWorld: more than " << EntityHandle::kIndexMask << " entities, the new one is not created" << std::endl;
+		return entity;
+	}
+
+	int EntityWorld::AppendRow(int archetype, EntityHandle entity)
+	{
+		Archetype& type = m_Archetypes[archetype];
+		int row = type.count;
+		if (row == (int)type.chunks.size() * type.chunkCapacity)
+		{
+			Chunk chunk;
+			chunk.storage.reset(new unsigned char[type.chunkBytes + kArrayAlignment - 1]);
+			std::uintptr_t address = reinterpret_cast<std::uintptr_t>(chunk.storage.get());
+			chunk.data = chunk.storage.get() + (kArrayAlignment - address % kArrayAlignment) % kArrayAlignment;
+			type.chunks.push_back(std::move(chunk));
+		}
+		type.count++;
+
+		GetEntity(archetype, row) = entity;
+		Location* location = m_Slots.Get(entity);
+		location->archetype = archetype;
+		location->row = row;
+		return row;
+	}
+
+	void EntityWorld::RemoveRow(int archetype, int row)
+	{
+		Archetype& type = m_Archetypes[archetype];
+		int last = type.count - 1;
+		if (row != last)
+		{
+			for (int id = 0; id < ComponentTypes::kMaxComponents; ++id)
+			{
+				if (type.offsets[id] >= 0)
+					std::memcpy(GetComponent(archetype, row, id), GetComponent(archetype, last, id), type.sizes[id]);
+			}
+
+			EntityHandle moved = GetEntity(archetype, last);
+			GetEntity(archetype, row) = moved;
+			m_Slots.Get(moved)->row = row;
+		}
+		type.count--;
+	}
+
+	void EntityWorld::MoveEntity(EntityHandle entity, int target)
+	{
+		const Location* location = m_Slots.Get(entity);
+		int source = location->archetype;
+		int sourceRow = location->row;
+		int targetRow = AppendRow(target, entity);
+
+		// Components both archetypes have come along, the new one is written by the caller
+		const Archetype& from = m_Archetypes[source];
+		const Archetype& to = m_Archetypes[target];
+		for (int id = 0; id < ComponentTypes::kMaxComponents; ++id)
+		{
+			if (from.offsets[id] >= 0 && to.offsets[id] >= 0)
+				std::memcpy(GetComponent(target, targetRow, id), GetComponent(source, sourceRow, id), from.sizes[id]);
+		}
+
+		RemoveRow(source, sourceRow);
+	}
+
+}
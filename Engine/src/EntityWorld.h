@@ -0,0 +1,203 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "EntityRegistry.h"
+
+namespace GameEngine {
+
+	// Components are plain structs, copied with memcpy when their entity changes archetype.
+	// Every type gets an id and a signature bit the first time it is used.
+	class ComponentTypes
+	{
+	public:
+		static const int kMaxComponents = 32;
+
+		template <class T>
+		static int GetId()
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Components are moved with memcpy");
+			static const int id = Register((int)sizeof(T), (int)alignof(T));
+			return id;
+		}
+
+		template <class... Ts>
+		static std::uint32_t GetMask()
+		{
+			std::uint32_t mask = 0;
+			int expand[] = { 0, (mask |= 1u << GetId<Ts>(), 0)... };
+			(void)expand;
+			return mask;
+		}
+
+		static int GetSize(int id);
+
+	private:
+		static int Register(int size, int alignment);
+	};
+
+	// Entities grouped by archetype, the set of components they have. Every archetype keeps its
+	// entities in 16 KiB chunks with one contiguous, 16 byte aligned array per component, and
+	// removing an entity moves the archetype's last one into its row, so arrays have no holes.
+	// Create, Add, Remove and Destroy move rows around and must not run inside Each or EachChunk.
+	class EntityWorld
+	{
+	public:
+		// Null once the handle space is used up. Places the entity straight in the archetype of its components, no moves on the way
+		template <class... Ts>
+		EntityHandle Create(const Ts&... components)
+		{
+			int archetype = FindArchetype(ComponentTypes::GetMask<Ts...>());
+			EntityHandle entity = AllocateHandle(archetype);
+			if (entity.IsNull())
+				return entity;
+			int row = AppendRow(archetype, entity);
+			int expand[] = { 0, (std::memcpy(GetComponent(archetype, row, ComponentTypes::GetId<Ts>()), &components, sizeof(Ts)), 0)... };
+			(void)expand;
+			return entity;
+		}
+
+		// Stale or null handles are ignored
+		void Destroy(EntityHandle entity);
+		bool IsAlive(EntityHandle entity) const;
+		int GetCount() const { return m_Slots.GetCount(); }
+		// Destroys every entity, handles given out so far stop resolving
+		void Clear();
+
+		// Sets the component, moving the entity to the archetype that has it if needed.
+		// Returns the stored component, null if the entity is gone.
+		template <class T>
+		T* Add(EntityHandle entity, const T& component = T())
+		{
+			int id = ComponentTypes::GetId<T>();
+			const Location* location = m_Slots.Get(entity);
+			if (location == nullptr)
+				return nullptr;
+			if (m_Archetypes[location->archetype].offsets[id] < 0)
+				MoveEntity(entity, GetAddTarget(location->archetype, id));
+
+			void* target = GetComponent(location->archetype, location->row, id);
+			std::memcpy(target, &component, sizeof(T));
+			return static_cast<T*>(target);
+		}
+
+		template <class T>
+		void Remove(EntityHandle entity)
+		{
+			int id = ComponentTypes::GetId<T>();
+			const Location* location = m_Slots.Get(entity);
+			if (location != nullptr && m_Archetypes[location->archetype].offsets[id] >= 0)
+				MoveEntity(entity, GetRemoveTarget(location->archetype, id));
+		}
+
+		// Null if the entity is gone or does not have the component. Valid until the next structural change.
+		template <class T>
+		T* Get(EntityHandle entity)
+		{
+			int id = ComponentTypes::GetId<T>();
+			const Location* location = m_Slots.Get(entity);
+			if (location == nullptr || m_Archetypes[location->archetype].offsets[id] < 0)
+				return nullptr;
+			return static_cast<T*>(GetComponent(location->archetype, location->row, id));
+		}
+
+		// fn(count, entities, arrays...) once per chunk of every archetype that has all of Ts,
+		// the arrays are contiguous and 16 byte aligned, made for loops the compiler can vectorize
+		template <class... Ts, class Fn>
+		void EachChunk(Fn fn)
+		{
+			std::uint32_t mask = ComponentTypes::GetMask<Ts...>();
+			for (Archetype& archetype : m_Archetypes)
+			{
+				if ((archetype.signature & mask) != mask)
+					continue;
+				for (int first = 0, chunk = 0; first < archetype.count; first += archetype.chunkCapacity, ++chunk)
+				{
+					unsigned char* data = archetype.chunks[chunk].data;
+					int count = (std::min)(archetype.chunkCapacity, archetype.count - first);
+					fn(count, reinterpret_cast<EntityHandle*>(data),
+						reinterpret_cast<Ts*>(data + archetype.offsets[ComponentTypes::GetId<Ts>()])...);
+				}
+			}
+		}
+
+		// fn(entity, components...) for every entity that has all of Ts
+		template <class... Ts, class Fn>
+		void Each(Fn fn)
+		{
+			EachChunk<Ts...>([&fn](int count, EntityHandle* entities, Ts*... arrays) {
+				for (int i = 0; i < count; ++i)
+					fn(entities[i], arrays[i]...);
+			});
+		}
+
+	private:
+		static const int kChunkBytes = 16 * 1024;
+		static const int kArrayAlignment = 16;
+		// new only aligns to 8 bytes on 32 bit Windows, so chunks take a little more and start at the next 16 byte boundary
+		struct Chunk
+		{
+			std::unique_ptr<unsigned char[]> storage;
+			unsigned char* data = nullptr;
+		};
+
+		struct Archetype
+		{
+			std::uint32_t signature = 0;
+			int chunkBytes = 0;
+			int chunkCapacity = 0;
+			// Byte offset of each component's array in a chunk, -1 if the archetype lacks it
+			std::array<int, ComponentTypes::kMaxComponents> offsets;
+			std::array<int, ComponentTypes::kMaxComponents> sizes;
+			// Archetype with one component more or less, found once and remembered
+			std::array<int, ComponentTypes::kMaxComponents> addTargets;
+			std::array<int, ComponentTypes::kMaxComponents> removeTargets;
+			std::vector<Chunk> chunks;
+			int count = 0;
+		};
+
+		// Where the entity of a handle lives
+		struct Location
+		{
+			int archetype = -1;
+			int row = 0;
+		};
+
+		int FindArchetype(std::uint32_t signature);
+		int GetAddTarget(int archetype, int id);
+		int GetRemoveTarget(int archetype, int id);
+
+		void* GetComponent(int archetype, int row, int id)
+		{
+			const Archetype& type = m_Archetypes[archetype];
+			int chunk = row / type.chunkCapacity;
+			int index = row % type.chunkCapacity;
+			return type.chunks[chunk].data + type.offsets[id] + index * type.sizes[id];
+		}
+
+		EntityHandle& GetEntity(int archetype, int row)
+		{
+			const Archetype& type = m_Archetypes[archetype];
+			return reinterpret_cast<EntityHandle*>(type.chunks[row / type.chunkCapacity].data)[row % type.chunkCapacity];
+		}
+
+		// Null once the handle space is used up
+		EntityHandle AllocateHandle(int archetype);
+		int AppendRow(int archetype, EntityHandle entity);
+		// Fills row with the archetype's last entity, the components in row are dropped
+		void RemoveRow(int archetype, int row);
+		void MoveEntity(EntityHandle entity, int target);
+
+		std::vector<Archetype> m_Archetypes;
+		std::unordered_map<std::uint32_t, int> m_ArchetypeBySignature;
+
+		HandleSlots<Location> m_Slots;
+	};
+
+}
@@ -0,0 +1,263 @@
+#include "GLRenderBackend.h"
+
+#include <iostream>
+
+#include <glad/glad.h>
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "GameLevel.h"
+#include "GLStateCache.h"
+
+namespace GameEngine {
+
+	static const unsigned int m_Indices[] = {  // note that we start from 0!
+					0, 1, 3,   // first triangle
+					1, 2, 3    // second triangle
+	};
+
+	static const float m_Vertices[] = {
+		// positions         // colors           // texture coords
+		0.5f,  0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   1.f, 1.f,   // top right
+		0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   1.f , 0.0f,   // bottom right
+	   -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   0.0f, 0.0f,   // bottom left
+	   -0.5f,  0.5f, 0.0f,   0.0f, 0.0f, 0.0f,   0.0f, 1.f    // top left
+	};
+
+	GLRenderBackend::GLRenderBackend(SDL_Window* window)
+		: m_Window(window)
+	{
+	}
+
+	bool GLRenderBackend::Init()
+	{
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+		// The shaders are GLSL 330 and instancing needs glVertexAttribDivisor
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+		SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
+
+		// Create an OpenGL context
+		m_Context = SDL_GL_CreateContext(m_Window);
+		if (!m_Context) {
+			std::cout << "Failed to create OpenGL context" << std::endl;
+			return false;
+		}
+
+		// Load OpenGL functions with GLAD
+		if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
+			std::cout << "Failed to initialize GLAD" << std::endl;
+			SDL_GL_DeleteContext(m_Context);
+			m_Context = nullptr;
+			return false;
+		}
+
+		SDL_GL_MakeCurrent(m_Window, m_Context);
+		glState.Invalidate();
+
+		if (!m_Shaders.Init())
+		{
+			// Nothing could be drawn with program 0, so the engine stops instead of running blind
+			std::cout << "Failed to build the engine shaders" << std::endl;
+			m_Shaders.Shutdown();
+			glState.Invalidate();
+			SDL_GL_DeleteContext(m_Context);
+			m_Context = nullptr;
+			return false;
+		}
+		m_SpriteBatch.Init(m_Shaders.Get(ShaderType::Sprite));
+		m_InstancedSprites.Init(m_Shaders.Get(ShaderType::InstancedSprite));
+
+		return true;
+	}
+
+	void GLRenderBackend::Shutdown()
+	{
+		m_SpriteBatch.Shutdown();
+		m_InstancedSprites.Shutdown();
+		m_Shaders.Shutdown();
+		glState.Invalidate();
+
+		if (m_Context)
+		{
+			SDL_GL_DeleteContext(m_Context);
+			m_Context = nullptr;
+		}
+	}
+
+	unsigned int GLRenderBackend::CreateTexture(const unsigned char* pixels, int width, int height)
+	{
+		GLuint texture;
+		glGenTextures(1, &texture);
+		glState.BindTexture(0, GL_TEXTURE_2D, texture);
+
+		// set the texture wrapping/filtering options (on the currently bound texture object)
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		// Rows of a 24 bit image are not always 4 byte aligned
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		return texture;
+	}
+
+	void GLRenderBackend::DestroyTexture(unsigned int texture)
+	{
+		glState.ForgetTexture(texture);
+		glDeleteTextures(1, &texture);
+	}
+
+	int GLRenderBackend::RegisterClip(const std::vector<int>& frames)
+	{
+		return m_InstancedSprites.RegisterClip(frames);
+	}
+
+	int GLRenderBackend::GetClipLength(int clip) const
+	{
+		return m_InstancedSprites.GetClipLength(clip);
+	}
+
+	void GLRenderBackend::CreateBackground(LevelBackground& layer)
+	{
+		const ShaderProgram& backgroundShader = m_Shaders.Get(ShaderType::Background);
+
+		if (layer.isTiled)
+		{
+			layer.tilemap.Build(backgroundShader, layer.numTiles.x, layer.numTiles.y,
+				layer.tileMapSize.columns, layer.tileMapSize.rows, layer.tileIDs);
+			return;
+		}
+
+		glGenBuffers(1, &layer.m_vbo); // Generate 1 buffer
+
+		glGenBuffers(1, &layer.m_ebo);
+
+		glGenVertexArrays(1, &layer.m_vao);
+
+		// 1. bind Vertex Array Object
+		glState.BindVertexArray(layer.m_vao);
+
+		// 2. copy our vertices array in a buffer for OpenGL to use
+		glBindBuffer(GL_ARRAY_BUFFER, layer.m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(m_Vertices), m_Vertices, GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, layer.m_ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m_Indices), m_Indices, GL_STATIC_DRAW);
+
+		// 3. then set our vertex attributes pointers
+		glEnableVertexAttribArray(backgroundShader.position);
+		glVertexAttribPointer(backgroundShader.position, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+
+		glEnableVertexAttribArray(backgroundShader.color);
+		glVertexAttribPointer(backgroundShader.color, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+
+		glEnableVertexAttribArray(backgroundShader.texCoord);
+		glVertexAttribPointer(backgroundShader.texCoord, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	}
+
+	void GLRenderBackend::DestroyBackground(LevelBackground& layer)
+	{
+		if (layer.isTiled)
+		{
+			layer.tilemap.Destroy();
+			return;
+		}
+
+		glDeleteBuffers(1, &layer.m_vbo);
+		glDeleteBuffers(1, &layer.m_ebo);
+		glState.ForgetVertexArray(layer.m_vao);
+		glDeleteVertexArrays(1, &layer.m_vao);
+		layer.m_vbo = layer.m_ebo = layer.m_vao = 0;
+	}
+
+	void GLRenderBackend::BeginFrame(float time)
+	{
+		glState.ResetCounters();
+
+		glClearColor(0.0f, 1.0f, 1.0f, 1.0f); // Cyan Blue
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		m_Time = time;
+		m_SpriteBatch.Begin();
+		m_InstancedSprites.Begin(m_Time);
+	}
+
+	// Draws the sprites collected so far, so whatever comes next lands on top of them
+	void GLRenderBackend::FlushSprites(RenderStats& stats)
+	{
+		m_SpriteBatch.End(stats);
+		m_InstancedSprites.End(stats);
+		m_SpriteBatch.Begin();
+		m_InstancedSprites.Begin(m_Time);
+	}
+
+	// The model matrix places and scales the whole layer
+	void GLRenderBackend::DrawBackground(LevelBackground& layer, RenderStats& stats)
+	{
+		FlushSprites(stats);
+
+		const ShaderProgram& shader = m_Shaders.Get(ShaderType::Background);
+		glState.UseProgram(shader.id);
+
+		glm::mat4 model = glm::mat4(1.0f); // Identity matrix
+		model = glm::translate(model, glm::vec3(layer.scrollRect.w, layer.scrollRect.h, 1.0f)); // Apply translation
+		model = glm::scale(model, glm::vec3(layer.size.x, layer.size.y, 1.0f)); // Apply scaling
+
+		// Pass the model matrix to the shader
+		glUniformMatrix4fv(shader.model, 1, GL_FALSE, glm::value_ptr(model));
+
+		glState.BindTexture(0, GL_TEXTURE_2D, layer.m_Texture);
+
+		if (layer.isTiled)
+		{
+			layer.tilemap.Draw(layer.scrollRect.h, layer.size.y, stats);
+		}
+		else
+		{
+			glState.BindVertexArray(layer.m_vao);
+			glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+			stats.drawCalls++;
+		}
+	}
+
+	void GLRenderBackend::DrawSprite(const SpriteDraw& sprite, ShaderType shader)
+	{
+		if (shader == ShaderType::Sprite)
+		{
+			m_SpriteBatch.Draw(sprite.texture, sprite.x, sprite.y, sprite.w, sprite.h,
+				sprite.u0, sprite.v0, sprite.u1, sprite.v1);
+		}
+		else if (sprite.clip >= 0)
+		{
+			m_InstancedSprites.DrawAnimated(sprite.texture, sprite.x, sprite.y, sprite.w, sprite.h, sprite.rotation,
+				sprite.clip, sprite.sheetColumns, sprite.sheetRows, sprite.startTime, sprite.frameDuration, sprite.loop,
+				sprite.r, sprite.g, sprite.b);
+		}
+		else
+		{
+			m_InstancedSprites.Draw(sprite.texture, sprite.x, sprite.y, sprite.w, sprite.h, sprite.rotation,
+				sprite.u0, sprite.v0, sprite.u1, sprite.v1, sprite.r, sprite.g, sprite.b);
+		}
+	}
+
+	void GLRenderBackend::EndFrame(RenderStats& stats)
+	{
+		m_SpriteBatch.End(stats);
+		m_InstancedSprites.End(stats);
+
+		stats.stateChangesIssued = glState.GetIssued();
+		stats.stateChangesElided = glState.GetElided();
+	}
+
+	void GLRenderBackend::Present()
+	{
+		SDL_GL_SwapWindow(m_Window);
+	}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "InstancedSpriteRenderer.h"
+#include "RenderBackend.h"
+#include "ShaderRegistry.h"
+#include "SpriteBatch.h"
+
+struct SDL_Window;
+
+namespace GameEngine {
+
+	// Draws with OpenGL 3.3 core into an SDL window
+	class GLRenderBackend : public RenderBackend
+	{
+	public:
+		explicit GLRenderBackend(SDL_Window* window);
+
+		// Creates the GL context on the window, loads GL and builds the shaders
+		bool Init() override;
+		void Shutdown() override;
+
+		unsigned int CreateTexture(const unsigned char* pixels, int width, int height) override;
+		void DestroyTexture(unsigned int texture) override;
+
+		int RegisterClip(const std::vector<int>& frames) override;
+		int GetClipLength(int clip) const override;
+
+		void CreateBackground(LevelBackground& layer) override;
+		void DestroyBackground(LevelBackground& layer) override;
+
+		void BeginFrame(float time) override;
+		void DrawBackground(LevelBackground& layer, RenderStats& stats) override;
+		void DrawSprite(const SpriteDraw& sprite, ShaderType shader) override;
+		void EndFrame(RenderStats& stats) override;
+		void Present() override;
+
+	private:
+		void FlushSprites(RenderStats& stats);
+
+		SDL_Window* m_Window = nullptr;
+		void* m_Context = nullptr;
+
+		ShaderRegistry m_Shaders;
+		SpriteBatch m_SpriteBatch;
+		InstancedSpriteRenderer m_InstancedSprites;
+		float m_Time = 0.0f;
+	};
+
+}
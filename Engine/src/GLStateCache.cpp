@@ -0,0 +1,129 @@
+#include "GLStateCache.h"
+
+#include <glad/glad.h>
+
+namespace GameEngine {
+
+	GLStateCache glState;
+
+	void GLStateCache::UseProgram(unsigned int program)
+	{
+		if (m_Program == program)
+		{
+			m_Elided++;
+			return;
+		}
+
+		glUseProgram(program);
+		m_Program = program;
+		m_Issued++;
+	}
+
+	void GLStateCache::BindVertexArray(unsigned int vao)
+	{
+		if (m_VertexArray == vao)
+		{
+			m_Elided++;
+			return;
+		}
+
+		glBindVertexArray(vao);
+		m_VertexArray = vao;
+		m_Issued++;
+	}
+
+	void GLStateCache::ActiveTexture(int unit)
+	{
+		if (m_ActiveUnit == unit)
+		{
+			m_Elided++;
+			return;
+		}
+
+		glActiveTexture(GL_TEXTURE0 + unit);
+		m_ActiveUnit = unit;
+		m_Issued++;
+	}
+
+	unsigned int* GLStateCache::TextureSlot(int unit, unsigned int target)
+	{
+		if (unit < 0 || unit >= kTextureUnits)
+			return nullptr;
+
+		if (target == GL_TEXTURE_2D)
+			return &m_Texture2D[unit];
+		if (target == GL_TEXTURE_BUFFER)
+			return &m_TextureBuffer[unit];
+		return nullptr;
+	}
+
+	void GLStateCache::BindTexture(int unit, unsigned int target, unsigned int texture)
+	{
+		unsigned int* slot = TextureSlot(unit, target);
+		if (slot != nullptr && *slot == texture)
+		{
+			m_Elided++;
+			return;
+		}
+
+		ActiveTexture(unit);
+		glBindTexture(target, texture);
+		m_Issued++;
+
+		if (slot != nullptr)
+			*slot = texture;
+	}
+
+	// GL drops deleted objects from the bindings, so their names must not look bound anymore
+	void GLStateCache::ForgetTexture(unsigned int texture)
+	{
+		for (int unit = 0; unit < kTextureUnits; ++unit)
+		{
+			if (m_Texture2D[unit] == texture)
+				m_Texture2D[unit] = kUnknown;
+			if (m_TextureBuffer[unit] == texture)
+				m_TextureBuffer[unit] = kUnknown;
+		}
+	}
+
+	void GLStateCache::ForgetVertexArray(unsigned int vao)
+	{
+		if (m_VertexArray == vao)
+			m_VertexArray = kUnknown;
+	}
+
+	void GLStateCache::ForgetProgram(unsigned int program)
+	{
+		if (m_Program == program)
+			m_Program = kUnknown;
+	}
+
+	void GLStateCache::Invalidate()
+	{
+		m_Program = kUnknown;
+		m_VertexArray = kUnknown;
+		m_ActiveUnit = -1;
+		for (int unit = 0; unit < kTextureUnits; ++unit)
+		{
+			m_Texture2D[unit] = kUnknown;
+			m_TextureBuffer[unit] = kUnknown;
+		}
+	}
+
+	void GLStateCache::ResetCounters()
+	{
+		m_Issued = 0;
+		m_Elided = 0;
+	}
+
+	int GLStateCache::GetIssued() const
+	{
+		return m_Issued;
+	}
+
+	int GLStateCache::GetElided() const
+	{
+		return m_Elided;
+	}
+
+}
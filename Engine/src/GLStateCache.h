@@ -0,0 +1,45 @@
+#pragma once
+
+namespace GameEngine {
+
+	// Remembers the program, vertex array and texture bindings the engine made last and skips
+	// calls that would not change them. Engine code binds those through here, code that calls GL
+	// directly has to Invalidate afterwards, and deleted objects have to be forgotten.
+	class GLStateCache
+	{
+	public:
+		void UseProgram(unsigned int program);
+		void BindVertexArray(unsigned int vao);
+		// unit is the texture unit index, not GL_TEXTURE0 + index. target is GL_TEXTURE_2D or GL_TEXTURE_BUFFER.
+		void BindTexture(int unit, unsigned int target, unsigned int texture);
+
+		void ForgetTexture(unsigned int texture);
+		void ForgetVertexArray(unsigned int vao);
+		void ForgetProgram(unsigned int program);
+		void Invalidate();
+
+		// Calls sent to GL and calls skipped since the last ResetCounters
+		void ResetCounters();
+		int GetIssued() const;
+		int GetElided() const;
+
+	private:
+		static const int kTextureUnits = 4;
+		static const unsigned int kUnknown = 0xFFFFFFFF;
+
+		void ActiveTexture(int unit);
+		unsigned int* TextureSlot(int unit, unsigned int target);
+
+		unsigned int m_Program = kUnknown;
+		unsigned int m_VertexArray = kUnknown;
+		int m_ActiveUnit = -1;
+		unsigned int m_Texture2D[kTextureUnits] = { kUnknown, kUnknown, kUnknown, kUnknown };
+		unsigned int m_TextureBuffer[kTextureUnits] = { kUnknown, kUnknown, kUnknown, kUnknown };
+
+		int m_Issued = 0;
+		int m_Elided = 0;
+	};
+
+	extern GLStateCache glState;
+
+}
@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include "GameObjects.h"
+#include "TilemapMesh.h"
 
 
 class LevelBackground
@@ -9,7 +10,6 @@ class LevelBackground
 public:
 	std::string background_path;
 	float scrollingSpeed = 0;
-	unsigned int m_ShaderProgram;
 	unsigned int m_vao;
 	unsigned int m_Texture;
 	unsigned int m_ebo;
@@ -21,7 +21,7 @@ public:
 		int rows;
 		int columns;
 	}tileMapSize;
-	float tiledVertices[32];
+	GameEngine::TilemapMesh tilemap; // Built once for tiled layers
 	std::vector<int> tileIDs; // New member to store tile IDs
 	struct
 	{
@@ -72,9 +72,12 @@ class GameLevel
 {
 public:
 	std::vector<GameObject*> levelObjects;
+	// Added since the last flush, they join levelObjects and get OnStart at the end of the tick
+	std::vector<GameObject*> pendingObjects;
 	std::vector<LevelBackground*> background;
 
 	void setLayerSize(int layerSize);
+	// Safe from any callback, the object gets its handle now and OnStart once the engine flushes spawns
 	void addObject(GameObject* obj);
 	
 
@@ -1,12 +1,25 @@
 #pragma once
+#include <cfloat>
+#include <cstdint>
 #include <string>
 #include "Animator.h"
+#include "EntityRegistry.h"
+#include "TagRegistry.h"
 
-typedef struct b2BodyId;
-typedef struct b2BodyDef;
-typedef struct b2ShapeId;
-typedef struct b2ShapeDef;
-typedef struct b2Polygon;
+namespace GameEngine {
+	class ObjectPoolBase;
+}
+
+// Draw order of level objects, lower layers are drawn first
+enum class RenderLayer
+{
+	Background,
+	Enemies,
+	Player,
+	Bullets,
+	Effects,
+	HUD
+};
 
 class GameObject
 {
@@ -14,41 +27,35 @@ public:
 	GameObject(bool visibility, bool isBullet, bool hasSense)
 			: visible(visibility), isBullet(isBullet), hasSense(hasSense) {
 	}
+	virtual ~GameObject() {}
 
-	~GameObject()
-	{
-		delete bodyId;
-		delete bodyDef;
-		delete shapeId;
-		delete shapeDef;
-		delete boxCollision;
-		
-		bodyId = nullptr;
-		bodyDef = nullptr;
-		shapeId = nullptr;
-		shapeDef = nullptr;
-		boxCollision = nullptr;
-	}
-	unsigned int m_ShaderProgram;
-	unsigned int m_vao;
-	unsigned int m_Texture;
-	unsigned int m_ebo;
-	unsigned int m_vbo;
+	unsigned int m_Texture = 0;
 	bool isInit = false;
 
 	float m_Vertices[32];
 	float elapsedTime = 0.f;
 
+	// GPU animation state, the clip id comes from the instanced renderer
+	int animationClip = -1;
+	float animationStartTime = 0.f;
+	int animationSteps = 0;
+
 	bool hasBox2d = true;
 
 
-	Animation* animation;
+	AnimationSlot animation;
 
 	struct {
 		float x = 0.0f;
 		float y = 0.0f;
 	}position;
 
+	// Position before the last simulation tick, frames are drawn in between the two
+	struct {
+		float x = 0.0f;
+		float y = 0.0f;
+	}previousPosition;
+
 	struct {
 		float w = 32.0f;
 		float h = 32.0f;
@@ -62,6 +69,23 @@ public:
 
 	float rotation = 0;
 
+	// Built-in straight line motion. Set before the object joins the level, in OnStart at the latest.
+	// The engine then moves it by velocity every tick and destroys it once it leaves the bounds,
+	// and OnUpdate is only called if callUpdate is set. The collision box, group and hasBox2d of
+	// a mover are read once as it joins.
+	struct {
+		bool enabled = false;
+		bool callUpdate = false;
+		float velocityX = 0.0f;
+		float velocityY = 0.0f;
+		float minX = -FLT_MAX;
+		float minY = -FLT_MAX;
+		float maxX = FLT_MAX;
+		float maxY = FLT_MAX;
+	}mover;
+
+	RenderLayer renderLayer = RenderLayer::Enemies;
+
 	bool visible = true;
 	bool isBullet = false;
 	bool hasSense = false;
@@ -70,20 +94,32 @@ public:
 	virtual void OnUpdate() {};
 	virtual void OnAnimationFinish() {};
 	virtual void OnCollideEnter(GameObject& contact) {};
+	// The touch that started OnCollideEnter ended. Not called if either object was destroyed first.
+	virtual void OnCollideExit(GameObject& contact) {};
 	void Destroy();
 	virtual void OnDestroyed() {};
 
-	std::string objectGroup;
+	// Interned group name, the collision filter, handlers and projectile groups all key on its id
+	GameEngine::Tag objectGroup;
+
+	// Box2D body packed with b2StoreBodyId, created by the engine on the first update and
+	// destroyed with the object. 0 while the object has no body.
+	std::uint64_t bodyHandle = 0;
 
-	b2BodyId* bodyId;
-	b2BodyDef* bodyDef;
-	b2ShapeId* shapeId;
-	b2ShapeDef* shapeDef;
-	b2Polygon* boxCollision;
+	// Given by addObject and revoked by the delete pass, other objects keep this instead of a pointer.
+	// A pooled object gets a new one every time it is spawned.
+	GameEngine::EntityHandle handle;
+	// Entity in the engine's EntityWorld standing in for this object, see LegacyObject
+	GameEngine::EntityHandle entity;
+	// Row of a mover in the engine's MoverSystem, -1 while it is not moved by it
+	int moverIndex = -1;
 
 
 	bool toBeCreated = true;
 	bool toBeDeleted = false;
+
+	// Set on objects spawned from an ObjectPool, the delete pass hands them back to it instead of deleting them
+	GameEngine::ObjectPoolBase* pool = nullptr;
 };
 
 class Pawn : public GameObject
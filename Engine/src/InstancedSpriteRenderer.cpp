@@ -0,0 +1,239 @@
+#include "InstancedSpriteRenderer.h"
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+#include "GLStateCache.h"
+
+namespace GameEngine {
+
+	static const int kInitialCapacity = 1024;
+
+	void InstancedSpriteRenderer::Init(const ShaderProgram& shader)
+	{
+		m_Shader = shader;
+
+		float quadVertices[] = {
+			// positions      // texture coords
+			0.5f,  0.5f,      1.f, 1.f,   // top right
+			0.5f, -0.5f,      1.f, 0.f,   // bottom right
+		   -0.5f, -0.5f,      0.f, 0.f,   // bottom left
+		   -0.5f,  0.5f,      0.f, 1.f    // top left
+		};
+
+		unsigned int quadIndices[] = {
+			0, 1, 3,   // first triangle
+			1, 2, 3    // second triangle
+		};
+
+		glGenVertexArrays(1, &m_vao);
+		glGenBuffers(1, &m_QuadVbo);
+		glGenBuffers(1, &m_ebo);
+		glGenBuffers(1, &m_InstanceVbo);
+
+		glState.BindVertexArray(m_vao);
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_QuadVbo);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(quadIndices), quadIndices, GL_STATIC_DRAW);
+
+		glEnableVertexAttribArray(shader.position);
+		glVertexAttribPointer(shader.position, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+		glEnableVertexAttribArray(shader.texCoord);
+		glVertexAttribPointer(shader.texCoord, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_InstanceVbo);
+
+		glEnableVertexAttribArray(shader.instanceTransform);
+		glVertexAttribDivisor(shader.instanceTransform, 1);
+
+		glEnableVertexAttribArray(shader.instanceRotation);
+		glVertexAttribDivisor(shader.instanceRotation, 1);
+
+		glEnableVertexAttribArray(shader.instanceUVRect);
+		glVertexAttribDivisor(shader.instanceUVRect, 1);
+
+		glEnableVertexAttribArray(shader.instanceColor);
+		glVertexAttribDivisor(shader.instanceColor, 1);
+
+		glEnableVertexAttribArray(shader.instanceClip);
+		glVertexAttribDivisor(shader.instanceClip, 1);
+
+		glEnableVertexAttribArray(shader.instanceTiming);
+		glVertexAttribDivisor(shader.instanceTiming, 1);
+
+		Reserve(kInitialCapacity);
+		PointInstanceAttributes(0);
+
+		glGenBuffers(1, &m_ClipBuffer);
+		glGenTextures(1, &m_ClipTexture);
+		m_ClipTableDirty = true;
+	}
+
+	void InstancedSpriteRenderer::Shutdown()
+	{
+		glDeleteBuffers(1, &m_QuadVbo);
+		glDeleteBuffers(1, &m_ebo);
+		glDeleteBuffers(1, &m_InstanceVbo);
+		glState.ForgetVertexArray(m_vao);
+		glDeleteVertexArrays(1, &m_vao);
+		glDeleteBuffers(1, &m_ClipBuffer);
+		glState.ForgetTexture(m_ClipTexture);
+		glDeleteTextures(1, &m_ClipTexture);
+
+		m_QuadVbo = m_ebo = m_InstanceVbo = m_vao = 0;
+		m_ClipBuffer = m_ClipTexture = 0;
+		m_Capacity = 0;
+	}
+
+	void InstancedSpriteRenderer::Reserve(int instanceCount)
+	{
+		if (instanceCount <= m_Capacity)
+			return;
+
+		int capacity = m_Capacity > 0 ? m_Capacity : kInitialCapacity;
+		while (capacity < instanceCount)
+			capacity *= 2;
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_InstanceVbo);
+		glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+
+		m_Capacity = capacity;
+	}
+
+	// GL 3.3 has no base instance for instanced draws, so every texture run
+	// points the instance attributes at its first instance instead.
+	// Expects the renderer VAO and the instance buffer to be bound.
+	void InstancedSpriteRenderer::PointInstanceAttributes(int firstInstance)
+	{
+		std::size_t base = firstInstance * sizeof(Instance);
+
+		glVertexAttribPointer(m_Shader.instanceTransform, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(base + offsetof(Instance, x)));
+		glVertexAttribPointer(m_Shader.instanceRotation, 1, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(base + offsetof(Instance, rotation)));
+		glVertexAttribPointer(m_Shader.instanceUVRect, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(base + offsetof(Instance, u0)));
+		glVertexAttribPointer(m_Shader.instanceColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance), (void*)(base + offsetof(Instance, r)));
+		glVertexAttribIPointer(m_Shader.instanceClip, 4, GL_UNSIGNED_INT, sizeof(Instance), (void*)(base + offsetof(Instance, clipStart)));
+		glVertexAttribPointer(m_Shader.instanceTiming, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(base + offsetof(Instance, startTime)));
+	}
+
+	int InstancedSpriteRenderer::RegisterClip(const std::vector<int>& frames)
+	{
+		auto found = m_ClipByFrames.find(frames);
+		if (found != m_ClipByFrames.end())
+			return found->second;
+
+		Clip clip = { (int)m_ClipFrames.size(), (int)frames.size() };
+		m_ClipFrames.insert(m_ClipFrames.end(), frames.begin(), frames.end());
+		m_ClipTableDirty = true;
+
+		int id = (int)m_Clips.size();
+		m_Clips.push_back(clip);
+		m_ClipByFrames[frames] = id;
+		return id;
+	}
+
+	int InstancedSpriteRenderer::GetClipLength(int clip) const
+	{
+		if (clip < 0 || clip >= (int)m_Clips.size())
+			return 0;
+		return m_Clips[clip].length;
+	}
+
+	void InstancedSpriteRenderer::Begin(float time)
+	{
+		m_Entries.clear();
+		m_Time = time;
+	}
+
+	void InstancedSpriteRenderer::Draw(unsigned int texture, float x, float y, float w, float h, float rotation,
+		float u0, float v0, float u1, float v1, int r, int g, int b)
+	{
+		Entry entry;
+		entry.texture = texture;
+		entry.instance = { x, y, w, h, rotation, u0, v0, u1, v1,
+			(std::uint8_t)r, (std::uint8_t)g, (std::uint8_t)b, 255,
+			0, 0, 0, 0,
+			0.0f, 0.0f, 0.0f };
+		m_Entries.push_back(entry);
+	}
+
+	void InstancedSpriteRenderer::DrawAnimated(unsigned int texture, float x, float y, float w, float h, float rotation,
+		int clip, int sheetColumns, int sheetRows, float startTime, float frameDuration, bool loop, int r, int g, int b)
+	{
+		if (clip < 0 || clip >= (int)m_Clips.size() || sheetColumns <= 0 || sheetRows <= 0 || frameDuration <= 0.0f)
+			return;
+
+		Entry entry;
+		entry.texture = texture;
+		entry.instance = { x, y, w, h, rotation, 0.0f, 0.0f, 1.0f, 1.0f,
+			(std::uint8_t)r, (std::uint8_t)g, (std::uint8_t)b, 255,
+			(std::uint32_t)m_Clips[clip].start, (std::uint32_t)m_Clips[clip].length, (std::uint32_t)sheetColumns, (std::uint32_t)sheetRows,
+			startTime, frameDuration, loop ? 1.0f : 0.0f };
+		m_Entries.push_back(entry);
+	}
+
+	void InstancedSpriteRenderer::End(RenderStats& stats)
+	{
+		if (m_Entries.empty())
+			return;
+
+		int instanceCount = (int)m_Entries.size();
+		m_Upload.resize(instanceCount);
+		for (int i = 0; i < instanceCount; ++i)
+		{
+			m_Upload[i] = m_Entries[i].instance;
+		}
+
+		// The clip table only changes when a new frame list shows up, usually in the first frames
+		if (m_ClipTableDirty)
+		{
+			if (m_ClipFrames.empty())
+				m_ClipFrames.push_back(0);
+
+			glBindBuffer(GL_TEXTURE_BUFFER, m_ClipBuffer);
+			glBufferData(GL_TEXTURE_BUFFER, m_ClipFrames.size() * sizeof(std::int32_t), m_ClipFrames.data(), GL_STATIC_DRAW);
+			glState.BindTexture(1, GL_TEXTURE_BUFFER, m_ClipTexture);
+			glTexBuffer(GL_TEXTURE_BUFFER, GL_R32I, m_ClipBuffer);
+			glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+			m_ClipTableDirty = false;
+		}
+
+		glState.UseProgram(m_Shader.id);
+		glUniform1f(m_Shader.time, m_Time);
+		glState.BindVertexArray(m_vao);
+
+		Reserve(instanceCount);
+
+		// Orphan last frame's storage so the driver does not stall on a buffer still in use
+		glBindBuffer(GL_ARRAY_BUFFER, m_InstanceVbo);
+		glBufferData(GL_ARRAY_BUFFER, m_Capacity * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, instanceCount * sizeof(Instance), m_Upload.data());
+
+		glState.BindTexture(1, GL_TEXTURE_BUFFER, m_ClipTexture);
+
+		int first = 0;
+		while (first < instanceCount)
+		{
+			unsigned int texture = m_Entries[first].texture;
+			int last = first + 1;
+			while (last < instanceCount && m_Entries[last].texture == texture)
+				++last;
+
+			PointInstanceAttributes(first);
+
+			glState.BindTexture(0, GL_TEXTURE_2D, texture);
+			glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, last - first);
+			stats.drawCalls++;
+
+			first = last;
+		}
+
+		stats.sprites += instanceCount;
+	}
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "RenderStats.h"
+#include "ShaderRegistry.h"
+
+namespace GameEngine {
+
+	// Draws sprites as instances of one static unit quad. Transform, UV rect, tint and
+	// animation clip live in a per instance buffer, so each sprite uploads 68 bytes.
+	// Instances draw in submission order and a texture change starts a new draw call.
+	class InstancedSpriteRenderer
+	{
+	public:
+		void Init(const ShaderProgram& shader);
+		void Shutdown();
+
+		// Returns the id of a clip playing the given sheet frames in order. Equal frame lists share one clip.
+		int RegisterClip(const std::vector<int>& frames);
+		int GetClipLength(int clip) const;
+
+		// time drives every animated instance drawn until End, in the same seconds as DrawAnimated startTime
+		void Begin(float time);
+		// x/y is the sprite center and w/h its size, both in clip space. rotation is in degrees, clockwise.
+		// u0/v0 is the bottom left and u1/v1 the top right texture coordinate, r/g/b the 0-255 tint.
+		void Draw(unsigned int texture, float x, float y, float w, float h, float rotation,
+			float u0, float v0, float u1, float v1, int r, int g, int b);
+		// Same as Draw but the vertex shader picks the frame of clip on a sheetColumns x sheetRows sheet,
+		// so the instance does not change while the clip plays.
+		void DrawAnimated(unsigned int texture, float x, float y, float w, float h, float rotation,
+			int clip, int sheetColumns, int sheetRows, float startTime, float frameDuration, bool loop, int r, int g, int b);
+		void End(RenderStats& stats);
+
+	private:
+		struct Instance
+		{
+			float x, y, w, h;
+			float rotation;
+			float u0, v0, u1, v1;
+			std::uint8_t r, g, b, a;
+			// 32 bits, the clip table of a long session can pass 65535 frames
+			std::uint32_t clipStart, clipLength, sheetColumns, sheetRows;
+			float startTime, frameDuration, loop;
+		};
+
+		struct Clip
+		{
+			int start;
+			int length;
+		};
+
+		struct Entry
+		{
+			unsigned int texture;
+			Instance instance;
+		};
+
+		void Reserve(int instanceCount);
+		void PointInstanceAttributes(int firstInstance);
+
+		std::vector<Entry> m_Entries;
+		std::vector<Instance> m_Upload;
+
+		std::vector<Clip> m_Clips;
+		std::vector<std::int32_t> m_ClipFrames;
+		std::map<std::vector<int>, int> m_ClipByFrames;
+		bool m_ClipTableDirty = false;
+		float m_Time = 0.0f;
+
+		ShaderProgram m_Shader;
+		unsigned int m_vao = 0;
+		unsigned int m_QuadVbo = 0;
+		unsigned int m_ebo = 0;
+		unsigned int m_InstanceVbo = 0;
+		unsigned int m_ClipBuffer = 0;
+		unsigned int m_ClipTexture = 0;
+		int m_Capacity = 0;
+	};
+
+}
@@ -0,0 +1,129 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace GameEngine {
+
+	JobSystem::~JobSystem()
+	{
+		Stop();
+	}
+
+	void JobSystem::Start(int workers)
+	{
+		Stop();
+
+		m_WorkerCount = (std::max)(workers, 1);
+		m_Stopping = false;
+		for (int i = 1; i < m_WorkerCount; ++i)
+		{
+			m_Threads.emplace_back(&JobSystem::WorkerLoop, this, (std::uint32_t)i);
+		}
+	}
+
+	void JobSystem::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stopping = true;
+		}
+		m_WorkReady.notify_all();
+
+		for (std::thread& thread : m_Threads)
+		{
+			thread.join();
+		}
+		m_Threads.clear();
+		m_WorkerCount = 1;
+	}
+
+	int JobSystem::GetWorkerCount() const
+	{
+		return m_WorkerCount;
+	}
+
+	JobSystem::Job* JobSystem::Submit(Work* work, int itemCount, int minRange, void* context)
+	{
+		if (itemCount <= 0)
+			return nullptr;
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		Job* job;
+		if (m_FreeJobs.empty())
+		{
+			m_Jobs.emplace_back(new Job());
+			job = m_Jobs.back().get();
+		}
+		else
+		{
+			job = m_FreeJobs.back();
+			m_FreeJobs.pop_back();
+		}
+
+		job->work = work;
+		job->context = context;
+		job->itemCount = itemCount;
+		job->rangeCount = (std::max)(1, (std::min)(m_WorkerCount, itemCount / (std::max)(minRange, 1)));
+		job->rangeSize = (itemCount + job->rangeCount - 1) / job->rangeCount;
+		job->rangeCount = (itemCount + job->rangeSize - 1) / job->rangeSize;
+		job->nextRange = 0;
+		job->finishedRanges = 0;
+		m_Queue.push_back(job);
+
+		lock.unlock();
+		if (job->rangeCount == 1)
+			m_WorkReady.notify_one();
+		else
+			m_WorkReady.notify_all();
+		return job;
+	}
+
+	void JobSystem::Wait(Job* job)
+	{
+		if (job == nullptr)
+			return;
+
+		// Box2D may wait for one job while ranges of another are queued that this one depends on,
+		// so the waiting thread takes any queued range, not just the ranges of job
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while (job->finishedRanges < job->rangeCount)
+		{
+			if (!RunRange(lock, 0))
+				m_JobDone.wait(lock);
+		}
+		m_FreeJobs.push_back(job);
+	}
+
+	bool JobSystem::RunRange(std::unique_lock<std::mutex>& lock, std::uint32_t worker)
+	{
+		if (m_Queue.empty())
+			return false;
+
+		Job* job = m_Queue.front();
+		int range = job->nextRange++;
+		if (job->nextRange == job->rangeCount)
+			m_Queue.pop_front();
+
+		lock.unlock();
+		int start = range * job->rangeSize;
+		int end = (std::min)(start + job->rangeSize, job->itemCount);
+		job->work(start, end, worker, job->context);
+		lock.lock();
+
+		if (++job->finishedRanges == job->rangeCount)
+			m_JobDone.notify_all();
+		return true;
+	}
+
+	void JobSystem::WorkerLoop(std::uint32_t worker)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while (!m_Stopping)
+		{
+			if (!RunRange(lock, worker))
+				m_WorkReady.wait(lock);
+		}
+	}
+
+}
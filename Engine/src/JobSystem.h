@@ -0,0 +1,64 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GameEngine {
+
+	// A small worker pool running parallel-for jobs, shaped after the task callbacks of b2WorldDef.
+	// The thread that waits for a job is worker 0 and runs queued ranges until the job is done,
+	// so a pool of n workers starts n - 1 threads. Jobs are only submitted and waited for from one thread.
+	class JobSystem
+	{
+	public:
+		// Same signature as b2TaskCallback, items [start, end) on worker index worker
+		typedef void Work(std::int32_t start, std::int32_t end, std::uint32_t worker, void* context);
+
+		// Handed out by Submit, the fields are owned by the pool and guarded by its mutex
+		struct Job
+		{
+			Work* work = nullptr;
+			void* context = nullptr;
+			int itemCount = 0;
+			int rangeSize = 0;
+			int rangeCount = 0;
+			int nextRange = 0;
+			int finishedRanges = 0;
+		};
+
+		~JobSystem();
+
+		// workers counts the calling thread, 1 runs everything on it
+		void Start(int workers);
+		void Stop();
+		int GetWorkerCount() const;
+
+		// Splits [0, itemCount) into at most one range per worker, each about minRange items or more.
+		// Every range may run at the same time as the others. Returns null if there is nothing to do.
+		Job* Submit(Work* work, int itemCount, int minRange, void* context);
+		// Returns once every range of job has run, job is reused afterwards
+		void Wait(Job* job);
+
+	private:
+		// Takes one range of the oldest queued job and runs it with the lock released
+		bool RunRange(std::unique_lock<std::mutex>& lock, std::uint32_t worker);
+		void WorkerLoop(std::uint32_t worker);
+
+		std::vector<std::thread> m_Threads;
+		int m_WorkerCount = 1;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_WorkReady;
+		std::condition_variable m_JobDone;
+		bool m_Stopping = false;
+
+		std::deque<Job*> m_Queue;
+		std::vector<std::unique_ptr<Job>> m_Jobs;
+		std::vector<Job*> m_FreeJobs;
+	};
+
+}
@@ -0,0 +1,167 @@
+#include "MoverSystem.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define MOVER_SYSTEM_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace GameEngine {
+
+	void MoverSystem::Add(GameObject& obj, const Contact& contact)
+	{
+		obj.moverIndex = (int)m_Objects.size();
+		m_Objects.push_back(&obj);
+		m_PreviousX.push_back(obj.position.x);
+		m_PreviousY.push_back(obj.position.y);
+		m_X.push_back(obj.position.x);
+		m_Y.push_back(obj.position.y);
+		m_VelocityX.push_back(obj.mover.velocityX);
+		m_VelocityY.push_back(obj.mover.velocityY);
+		m_MinX.push_back(obj.mover.minX);
+		m_MinY.push_back(obj.mover.minY);
+		m_MaxX.push_back(obj.mover.maxX);
+		m_MaxY.push_back(obj.mover.maxY);
+		m_Outside.push_back(0);
+		// OnStart may have destroyed it already
+		m_Destroyed.push_back(obj.toBeDeleted ? 1 : 0);
+		m_Contacts.push_back(contact);
+	}
+
+	// Same operations in the same order on both paths, so SSE2 and scalar builds move objects identically.
+	// The previous arrays take the positions of the last tick, which the objects hold unless game code moved them.
+	void MoverSystem::Integrate(float timeStep)
+	{
+		int count = (int)m_Objects.size();
+		int i = 0;
+
+#ifdef MOVER_SYSTEM_SSE2
+		const __m128 step = _mm_set1_ps(timeStep);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 previousX = _mm_loadu_ps(&m_X[i]);
+			__m128 previousY = _mm_loadu_ps(&m_Y[i]);
+			__m128 x = _mm_add_ps(previousX, _mm_mul_ps(_mm_loadu_ps(&m_VelocityX[i]), step));
+			__m128 y = _mm_add_ps(previousY, _mm_mul_ps(_mm_loadu_ps(&m_VelocityY[i]), step));
+			_mm_storeu_ps(&m_PreviousX[i], previousX);
+			_mm_storeu_ps(&m_PreviousY[i], previousY);
+			_mm_storeu_ps(&m_X[i], x);
+			_mm_storeu_ps(&m_Y[i], y);
+
+			__m128 outside = _mm_or_ps(
+				_mm_or_ps(_mm_cmplt_ps(x, _mm_loadu_ps(&m_MinX[i])), _mm_cmpgt_ps(x, _mm_loadu_ps(&m_MaxX[i]))),
+				_mm_or_ps(_mm_cmplt_ps(y, _mm_loadu_ps(&m_MinY[i])), _mm_cmpgt_ps(y, _mm_loadu_ps(&m_MaxY[i]))));
+			int lanes = _mm_movemask_ps(outside);
+			m_Outside[i] = lanes & 1;
+			m_Outside[i + 1] = (lanes >> 1) & 1;
+			m_Outside[i + 2] = (lanes >> 2) & 1;
+			m_Outside[i + 3] = (lanes >> 3) & 1;
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			m_PreviousX[i] = m_X[i];
+			m_PreviousY[i] = m_Y[i];
+			m_X[i] = m_X[i] + m_VelocityX[i] * timeStep;
+			m_Y[i] = m_Y[i] + m_VelocityY[i] * timeStep;
+			m_Outside[i] = m_X[i] < m_MinX[i] || m_X[i] > m_MaxX[i] || m_Y[i] < m_MinY[i] || m_Y[i] > m_MaxY[i];
+		}
+	}
+
+	void MoverSystem::WriteBack(float timeStep)
+	{
+		// The only pass that touches the objects, it reads position just before writing it
+		int count = (int)m_Objects.size();
+		for (int i = 0; i < count; ++i)
+		{
+			if (m_Destroyed[i])
+				continue;
+
+			GameObject& obj = *m_Objects[i];
+			if (obj.position.x != m_PreviousX[i] || obj.position.y != m_PreviousY[i])
+			{
+				m_PreviousX[i] = obj.position.x;
+				m_PreviousY[i] = obj.position.y;
+				m_X[i] = m_PreviousX[i] + m_VelocityX[i] * timeStep;
+				m_Y[i] = m_PreviousY[i] + m_VelocityY[i] * timeStep;
+				m_Outside[i] = m_X[i] < m_MinX[i] || m_X[i] > m_MaxX[i] || m_Y[i] < m_MinY[i] || m_Y[i] > m_MaxY[i];
+			}
+
+			obj.previousPosition.x = m_PreviousX[i];
+			obj.previousPosition.y = m_PreviousY[i];
+			obj.position.x = m_X[i];
+			obj.position.y = m_Y[i];
+			if (m_Outside[i])
+				obj.Destroy();
+		}
+	}
+
+	void MoverSystem::ForgetDestroyed()
+	{
+		int count = (int)m_Objects.size();
+		int kept = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			if (m_Destroyed[i])
+			{
+				m_Objects[i]->moverIndex = -1;
+				continue;
+			}
+
+			if (kept != i)
+			{
+				m_Objects[i]->moverIndex = kept;
+				m_Objects[kept] = m_Objects[i];
+				m_PreviousX[kept] = m_PreviousX[i];
+				m_PreviousY[kept] = m_PreviousY[i];
+				m_X[kept] = m_X[i];
+				m_Y[kept] = m_Y[i];
+				m_VelocityX[kept] = m_VelocityX[i];
+				m_VelocityY[kept] = m_VelocityY[i];
+				m_MinX[kept] = m_MinX[i];
+				m_MinY[kept] = m_MinY[i];
+				m_MaxX[kept] = m_MaxX[i];
+				m_MaxY[kept] = m_MaxY[i];
+				m_Contacts[kept] = m_Contacts[i];
+			}
+			m_Destroyed[kept] = 0;
+			kept++;
+		}
+
+		m_Objects.resize(kept);
+		m_PreviousX.resize(kept);
+		m_PreviousY.resize(kept);
+		m_X.resize(kept);
+		m_Y.resize(kept);
+		m_VelocityX.resize(kept);
+		m_VelocityY.resize(kept);
+		m_MinX.resize(kept);
+		m_MinY.resize(kept);
+		m_MaxX.resize(kept);
+		m_MaxY.resize(kept);
+		m_Outside.resize(kept);
+		m_Destroyed.resize(kept);
+		m_Contacts.resize(kept);
+	}
+
+	void MoverSystem::Clear()
+	{
+		for (GameObject* obj : m_Objects)
+			obj->moverIndex = -1;
+		m_Objects.clear();
+		m_PreviousX.clear();
+		m_PreviousY.clear();
+		m_X.clear();
+		m_Y.clear();
+		m_VelocityX.clear();
+		m_VelocityY.clear();
+		m_MinX.clear();
+		m_MinY.clear();
+		m_MaxX.clear();
+		m_MaxY.clear();
+		m_Outside.clear();
+		m_Destroyed.clear();
+		m_Contacts.clear();
+	}
+
+}
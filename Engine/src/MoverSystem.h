@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "GameObjects.h"
+
+namespace GameEngine {
+
+	// Straight line motion for objects that only fly across the screen, like bullets and asteroids.
+	// Positions, velocities and bounds of every mover live in SoA arrays and are the ones that count,
+	// GameObject::position only mirrors them for game code and drawing. Each tick Integrate moves four
+	// movers at a time and WriteBack copies the results out, the engine then syncs bodies and fills the
+	// projectile grid from the arrays too. Movers without callUpdate never go through the update loop.
+	class MoverSystem
+	{
+	public:
+		// How the engine's collision passes see a mover, filled in when it joins. The engine refreshes
+		// category and mask when the collision matrix changes.
+		struct Contact
+		{
+			// Moved along with a Box2D body. The body itself stays GameObject::bodyHandle, which a new
+			// physics world clears, and the engine creates it again on the next tick.
+			bool body = false;
+			std::uint64_t category = 0;
+			std::uint64_t mask = 0;
+			float width = 0.0f;
+			float height = 0.0f;
+			bool inGrid = false;
+			bool projectile = false;
+		};
+
+		// Registers obj and sets its moverIndex. GameObject::mover is read once here.
+		void Add(GameObject& obj, const Contact& contact);
+		// Called by GameObject::Destroy, the mover stops moving and colliding right away
+		void MarkDestroyed(int index) { m_Destroyed[index] = 1; }
+
+		// Moves every mover over timeStep, on the arrays only
+		void Integrate(float timeStep);
+		// Copies the new positions and the ones before to the objects and destroys the movers that left
+		// their bounds. A mover game code placed somewhere else since the last tick moves on from there.
+		void WriteBack(float timeStep);
+
+		int GetCount() const { return (int)m_Objects.size(); }
+		bool IsDestroyed(int index) const { return m_Destroyed[index] != 0; }
+		GameObject& GetObject(int index) const { return *m_Objects[index]; }
+		float GetX(int index) const { return m_X[index]; }
+		float GetY(int index) const { return m_Y[index]; }
+		Contact& GetContact(int index) { return m_Contacts[index]; }
+
+		// Drops every destroyed mover, in one pass
+		void ForgetDestroyed();
+		void Clear();
+
+	private:
+		std::vector<GameObject*> m_Objects;
+		// Where the last WriteBack left every mover, what its object should still hold
+		std::vector<float> m_PreviousX;
+		std::vector<float> m_PreviousY;
+		std::vector<float> m_X;
+		std::vector<float> m_Y;
+		std::vector<float> m_VelocityX;
+		std::vector<float> m_VelocityY;
+		std::vector<float> m_MinX;
+		std::vector<float> m_MinY;
+		std::vector<float> m_MaxX;
+		std::vector<float> m_MaxY;
+		std::vector<std::uint8_t> m_Outside;
+		std::vector<std::uint8_t> m_Destroyed;
+		std::vector<Contact> m_Contacts;
+	};
+
+}
@@ -0,0 +1,96 @@
+#include "NullRenderBackend.h"
+
+namespace GameEngine {
+
+	bool NullRenderBackend::Init()
+	{
+		return true;
+	}
+
+	void NullRenderBackend::Shutdown()
+	{
+		m_ClipLengths.clear();
+		m_ClipByFrames.clear();
+	}
+
+	unsigned int NullRenderBackend::CreateTexture(const unsigned char* pixels, int width, int height)
+	{
+		return m_NextTexture++;
+	}
+
+	void NullRenderBackend::DestroyTexture(unsigned int texture)
+	{
+	}
+
+	int NullRenderBackend::RegisterClip(const std::vector<int>& frames)
+	{
+		auto found = m_ClipByFrames.find(frames);
+		if (found != m_ClipByFrames.end())
+			return found->second;
+
+		int id = (int)m_ClipLengths.size();
+		m_ClipLengths.push_back((int)frames.size());
+		m_ClipByFrames[frames] = id;
+		return id;
+	}
+
+	int NullRenderBackend::GetClipLength(int clip) const
+	{
+		if (clip < 0 || clip >= (int)m_ClipLengths.size())
+			return 0;
+		return m_ClipLengths[clip];
+	}
+
+	void NullRenderBackend::CreateBackground(LevelBackground& layer)
+	{
+	}
+
+	void NullRenderBackend::DestroyBackground(LevelBackground& layer)
+	{
+	}
+
+	void NullRenderBackend::BeginFrame(float time)
+	{
+		m_RunOpen = false;
+		m_PendingSprites = 0;
+		m_PendingDrawCalls = 0;
+	}
+
+	void NullRenderBackend::FlushSprites(RenderStats& stats)
+	{
+		stats.sprites += m_PendingSprites;
+		stats.drawCalls += m_PendingDrawCalls;
+
+		m_RunOpen = false;
+		m_PendingSprites = 0;
+		m_PendingDrawCalls = 0;
+	}
+
+	void NullRenderBackend::DrawBackground(LevelBackground& layer, RenderStats& stats)
+	{
+		FlushSprites(stats);
+		stats.drawCalls++;
+	}
+
+	void NullRenderBackend::DrawSprite(const SpriteDraw& sprite, ShaderType shader)
+	{
+		if (!m_RunOpen || sprite.texture != m_RunTexture || shader != m_RunShader)
+		{
+			m_RunOpen = true;
+			m_RunTexture = sprite.texture;
+			m_RunShader = shader;
+			m_PendingDrawCalls++;
+		}
+		m_PendingSprites++;
+	}
+
+	void NullRenderBackend::EndFrame(RenderStats& stats)
+	{
+		FlushSprites(stats);
+	}
+
+	void NullRenderBackend::Present()
+	{
+	}
+
+}
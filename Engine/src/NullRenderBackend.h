@@ -0,0 +1,48 @@
+#pragma once
+#include <map>
+#include <vector>
+
+#include "RenderBackend.h"
+
+namespace GameEngine {
+
+	// Makes no graphics calls at all, for running the engine without a window or GPU.
+	// Draw calls are counted the way the GL backend would issue them, so the stats stay comparable.
+	class NullRenderBackend : public RenderBackend
+	{
+	public:
+		bool Init() override;
+		void Shutdown() override;
+
+		unsigned int CreateTexture(const unsigned char* pixels, int width, int height) override;
+		void DestroyTexture(unsigned int texture) override;
+
+		int RegisterClip(const std::vector<int>& frames) override;
+		int GetClipLength(int clip) const override;
+
+		void CreateBackground(LevelBackground& layer) override;
+		void DestroyBackground(LevelBackground& layer) override;
+
+		void BeginFrame(float time) override;
+		void DrawBackground(LevelBackground& layer, RenderStats& stats) override;
+		void DrawSprite(const SpriteDraw& sprite, ShaderType shader) override;
+		void EndFrame(RenderStats& stats) override;
+		void Present() override;
+
+	private:
+		void FlushSprites(RenderStats& stats);
+
+		unsigned int m_NextTexture = 1;
+
+		std::vector<int> m_ClipLengths;
+		std::map<std::vector<int>, int> m_ClipByFrames;
+
+		// The sprite run being collected, a texture or shader change starts a new draw call
+		bool m_RunOpen = false;
+		unsigned int m_RunTexture = 0;
+		ShaderType m_RunShader = ShaderType::Sprite;
+		int m_PendingSprites = 0;
+		int m_PendingDrawCalls = 0;
+	};
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+
+#include "GameObjects.h"
+
+namespace GameEngine {
+
+	// The side of a pool the engine sees, it takes back the objects of the delete pass
+	class ObjectPoolBase
+	{
+	public:
+		virtual ~ObjectPoolBase() {}
+		virtual void Recycle(GameObject* obj) = 0;
+	};
+
+	// Free list of one short lived object type, like bullets or explosions. Recycled objects keep their
+	// animation and texture, so spawning one again and adding it to the level allocates nothing.
+	// Spawn resets the state the engine keeps on GameObject, OnStart runs again when the object is added
+	// and is where game code resets its own members. The pool must outlive the levels it spawns into.
+	template <class T>
+	class ObjectPool : public ObjectPoolBase
+	{
+	public:
+		~ObjectPool()
+		{
+			for (T* obj : m_Free)
+				delete obj;
+		}
+
+		// Creates count objects up front, so the first burst does not allocate either
+		void Reserve(int count)
+		{
+			m_Free.reserve(m_Free.size() + count);
+			for (int i = 0; i < count; ++i)
+			{
+				T* obj = new T();
+				obj->pool = this;
+				m_Free.push_back(obj);
+			}
+		}
+
+		T* Spawn()
+		{
+			if (m_Free.empty())
+			{
+				T* obj = new T();
+				obj->pool = this;
+				return obj;
+			}
+
+			T* obj = m_Free.back();
+			m_Free.pop_back();
+
+			obj->toBeDeleted = false;
+			obj->isInit = false;
+			obj->elapsedTime = 0.f;
+			obj->animationSteps = 0;
+			obj->position.x = 0.f;
+			obj->position.y = 0.f;
+			obj->rotation = 0.f;
+			obj->modulate.r = 255;
+			obj->modulate.g = 255;
+			obj->modulate.b = 255;
+			if (obj->animation != nullptr)
+			{
+				obj->animation->currentFrame = 0;
+				obj->animation->targetFrame = 0;
+				obj->animation->frameTime = 0.f;
+			}
+			return obj;
+		}
+
+		void Recycle(GameObject* obj) override
+		{
+			m_Free.push_back(static_cast<T*>(obj));
+		}
+
+		int GetFreeCount() const { return (int)m_Free.size(); }
+
+	private:
+		std::vector<T*> m_Free;
+	};
+
+}
@@ -0,0 +1,281 @@
+#include "ProjectileCollision.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define PROJECTILE_COLLISION_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace GameEngine {
+
+	// Bounds the grid memory when objects are spread far apart, cells grow instead
+	static const int kMaxGridCells = 256 * 256;
+
+	// Both orders of a pair look the same in the sorted lists
+	static std::pair<GameObject*, GameObject*> SortKey(const std::pair<GameObject*, GameObject*>& pair)
+	{
+		return pair.first < pair.second ? pair : std::make_pair(pair.second, pair.first);
+	}
+
+#ifdef PROJECTILE_COLLISION_SSE2
+	// One bit for each of the four 64 bit values that shares a bit with bits
+	static int SharesBits(const std::uint64_t* values, __m128i bits)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		__m128i low = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)values), bits), zero);
+		__m128i high = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)(values + 2)), bits), zero);
+
+		// A value is empty when both of its 32 bit halves are
+		low = _mm_and_si128(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+		high = _mm_and_si128(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+		__m128 empty = _mm_shuffle_ps(_mm_castsi128_ps(low), _mm_castsi128_ps(high), _MM_SHUFFLE(2, 0, 2, 0));
+		return ~_mm_movemask_ps(empty) & 0xF;
+	}
+#endif
+
+	void ProjectileCollision::SetGroup(Tag group, bool enabled)
+	{
+		if (enabled)
+			m_Groups.Add(group);
+		else
+			m_Groups.Remove(group);
+	}
+
+	bool ProjectileCollision::HasGroups() const
+	{
+		return !m_Groups.IsEmpty();
+	}
+
+	void ProjectileCollision::SetCellSize(float size)
+	{
+		if (size > 0.0f)
+			m_CellSize = size;
+	}
+
+	void ProjectileCollision::Begin()
+	{
+		m_Objects.clear();
+		m_MinX.clear();
+		m_MinY.clear();
+		m_MaxX.clear();
+		m_MaxY.clear();
+		m_Categories.clear();
+		m_Masks.clear();
+		m_IsProjectile.clear();
+		m_Projectiles.clear();
+	}
+
+	void ProjectileCollision::Add(GameObject& obj, float x, float y, float width, float height, bool projectile, std::uint64_t category, std::uint64_t mask)
+	{
+		if (projectile)
+			m_Projectiles.push_back((int)m_Objects.size());
+
+		m_Objects.push_back(&obj);
+		m_MinX.push_back(x);
+		m_MinY.push_back(y);
+		m_MaxX.push_back(x + width);
+		m_MaxY.push_back(y + height);
+		m_Categories.push_back(category);
+		m_Masks.push_back(mask);
+		m_IsProjectile.push_back(projectile);
+	}
+
+	void ProjectileCollision::BuildGrid()
+	{
+		int count = (int)m_Objects.size();
+
+		float minX = m_MinX[0], minY = m_MinY[0], maxX = m_MaxX[0], maxY = m_MaxY[0];
+		for (int i = 1; i < count; ++i)
+		{
+			minX = (std::min)(minX, m_MinX[i]);
+			minY = (std::min)(minY, m_MinY[i]);
+			maxX = (std::max)(maxX, m_MaxX[i]);
+			maxY = (std::max)(maxY, m_MaxY[i]);
+		}
+
+		m_GridX = minX;
+		m_GridY = minY;
+		m_GridCellSize = m_CellSize;
+		for (;;)
+		{
+			m_GridWidth = (int)((maxX - minX) / m_GridCellSize) + 1;
+			m_GridHeight = (int)((maxY - minY) / m_GridCellSize) + 1;
+			if ((long long)m_GridWidth * m_GridHeight <= kMaxGridCells)
+				break;
+			m_GridCellSize *= 2.0f;
+		}
+
+		// Counting sort of the objects into every cell their box touches
+		int cells = m_GridWidth * m_GridHeight;
+		m_CellStart.assign(cells + 1, 0);
+
+		for (int i = 0; i < count; ++i)
+		{
+			int x0 = (int)((m_MinX[i] - m_GridX) / m_GridCellSize);
+			int y0 = (int)((m_MinY[i] - m_GridY) / m_GridCellSize);
+			int x1 = (int)((m_MaxX[i] - m_GridX) / m_GridCellSize);
+			int y1 = (int)((m_MaxY[i] - m_GridY) / m_GridCellSize);
+			for (int y = y0; y <= y1; ++y)
+				for (int x = x0; x <= x1; ++x)
+					++m_CellStart[y * m_GridWidth + x + 1];
+		}
+
+		for (int c = 0; c < cells; ++c)
+			m_CellStart[c + 1] += m_CellStart[c];
+
+		int slots = m_CellStart[cells];
+		m_SlotObject.resize(slots);
+		m_SlotMinX.resize(slots);
+		m_SlotMinY.resize(slots);
+		m_SlotMaxX.resize(slots);
+		m_SlotMaxY.resize(slots);
+		m_SlotCategories.resize(slots);
+		m_SlotMasks.resize(slots);
+
+		m_CellFill.assign(m_CellStart.begin(), m_CellStart.end() - 1);
+		for (int i = 0; i < count; ++i)
+		{
+			int x0 = (int)((m_MinX[i] - m_GridX) / m_GridCellSize);
+			int y0 = (int)((m_MinY[i] - m_GridY) / m_GridCellSize);
+			int x1 = (int)((m_MaxX[i] - m_GridX) / m_GridCellSize);
+			int y1 = (int)((m_MaxY[i] - m_GridY) / m_GridCellSize);
+			for (int y = y0; y <= y1; ++y)
+			{
+				for (int x = x0; x <= x1; ++x)
+				{
+					int slot = m_CellFill[y * m_GridWidth + x]++;
+					m_SlotObject[slot] = i;
+					m_SlotMinX[slot] = m_MinX[i];
+					m_SlotMinY[slot] = m_MinY[i];
+					m_SlotMaxX[slot] = m_MaxX[i];
+					m_SlotMaxY[slot] = m_MaxY[i];
+					m_SlotCategories[slot] = m_Categories[i];
+					m_SlotMasks[slot] = m_Masks[i];
+				}
+			}
+		}
+	}
+
+	void ProjectileCollision::FindPairs()
+	{
+		m_LastTestedBy.assign(m_Objects.size(), -1);
+
+		for (int p : m_Projectiles)
+		{
+			float minX = m_MinX[p], minY = m_MinY[p], maxX = m_MaxX[p], maxY = m_MaxY[p];
+
+			// Called for slots that overlap and pass the filter. A candidate in several cells is only
+			// taken once per projectile. Two projectiles find each other, the pair is kept from the lower index.
+			auto take = [&](int slot) {
+				int other = m_SlotObject[slot];
+				if (other == p || m_LastTestedBy[other] == p || (m_IsProjectile[other] && other < p))
+					return;
+				m_LastTestedBy[other] = p;
+
+				m_Pairs.push_back(Pair(m_Objects[p], m_Objects[other]));
+			};
+
+			int x0 = (int)((minX - m_GridX) / m_GridCellSize);
+			int y0 = (int)((minY - m_GridY) / m_GridCellSize);
+			int x1 = (int)((maxX - m_GridX) / m_GridCellSize);
+			int y1 = (int)((maxY - m_GridY) / m_GridCellSize);
+
+#ifdef PROJECTILE_COLLISION_SSE2
+			const __m128 boxMinX = _mm_set1_ps(minX);
+			const __m128 boxMinY = _mm_set1_ps(minY);
+			const __m128 boxMaxX = _mm_set1_ps(maxX);
+			const __m128 boxMaxY = _mm_set1_ps(maxY);
+			const __m128i category = _mm_set1_epi64x((long long)m_Categories[p]);
+			const __m128i mask = _mm_set1_epi64x((long long)m_Masks[p]);
+#endif
+
+			for (int y = y0; y <= y1; ++y)
+			{
+				for (int x = x0; x <= x1; ++x)
+				{
+					int cell = y * m_GridWidth + x;
+					int slot = m_CellStart[cell];
+					int end = m_CellStart[cell + 1];
+
+#ifdef PROJECTILE_COLLISION_SSE2
+					for (; slot + 4 <= end; slot += 4)
+					{
+						__m128 overlap = _mm_and_ps(
+							_mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(&m_SlotMinX[slot]), boxMaxX),
+								_mm_cmplt_ps(boxMinX, _mm_loadu_ps(&m_SlotMaxX[slot]))),
+							_mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(&m_SlotMinY[slot]), boxMaxY),
+								_mm_cmplt_ps(boxMinY, _mm_loadu_ps(&m_SlotMaxY[slot]))));
+
+						// Bullets pass over each other far more often than they hit something,
+						// filtering here keeps those pairs out of the branchy part
+						int hits = _mm_movemask_ps(overlap);
+						if (hits != 0)
+							hits &= SharesBits(&m_SlotMasks[slot], category) & SharesBits(&m_SlotCategories[slot], mask);
+						for (int lane = 0; hits != 0; ++lane, hits >>= 1)
+						{
+							if (hits & 1)
+								take(slot + lane);
+						}
+					}
+#endif
+
+					for (; slot < end; ++slot)
+					{
+						if (m_SlotMinX[slot] < maxX && minX < m_SlotMaxX[slot]
+							&& m_SlotMinY[slot] < maxY && minY < m_SlotMaxY[slot]
+							&& (m_Categories[p] & m_SlotMasks[slot]) != 0 && (m_SlotCategories[slot] & m_Masks[p]) != 0)
+							take(slot);
+					}
+				}
+			}
+		}
+	}
+
+	void ProjectileCollision::Update(ContactDispatcher& dispatcher)
+	{
+		std::swap(m_Pairs, m_PreviousPairs);
+		std::swap(m_SortedPairs, m_PreviousSortedPairs);
+		m_Pairs.clear();
+
+		if (!m_Projectiles.empty())
+		{
+			BuildGrid();
+			FindPairs();
+		}
+		m_SortedPairs.clear();
+		for (const Pair& pair : m_Pairs)
+			m_SortedPairs.push_back(SortKey(pair));
+		std::sort(m_SortedPairs.begin(), m_SortedPairs.end());
+
+		for (const Pair& pair : m_Pairs)
+		{
+			if (!std::binary_search(m_PreviousSortedPairs.begin(), m_PreviousSortedPairs.end(), SortKey(pair)))
+				dispatcher.AddBegin(*pair.first, *pair.second);
+		}
+
+		for (const Pair& pair : m_PreviousPairs)
+		{
+			// Objects removed this tick are not in the current pairs, they get no exit either
+			if (pair.first->toBeDeleted || pair.second->toBeDeleted)
+				continue;
+			if (!std::binary_search(m_SortedPairs.begin(), m_SortedPairs.end(), SortKey(pair)))
+				dispatcher.AddEnd(*pair.first, *pair.second);
+		}
+	}
+
+	void ProjectileCollision::ForgetDestroyed()
+	{
+		auto involves = [](const Pair& pair) { return pair.first->toBeDeleted || pair.second->toBeDeleted; };
+		m_Pairs.erase(std::remove_if(m_Pairs.begin(), m_Pairs.end(), involves), m_Pairs.end());
+		m_SortedPairs.erase(std::remove_if(m_SortedPairs.begin(), m_SortedPairs.end(), involves), m_SortedPairs.end());
+	}
+
+	void ProjectileCollision::Clear()
+	{
+		m_Pairs.clear();
+		m_SortedPairs.clear();
+	}
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ContactDispatcher.h"
+#include "GameObjects.h"
+
+namespace GameEngine {
+
+	// Overlap tests for small, numerous objects like bullets, without Box2D bodies.
+	// Every tick the collidable objects are binned into a uniform grid and each projectile
+	// tests the boxes of the cells it covers, four at a time from SoA arrays.
+	// Pairs pass the same category/mask test as Box2D shapes. An overlap that starts or ends
+	// is reported to the contact dispatcher like a Box2D touch.
+	class ProjectileCollision
+	{
+	public:
+		// Objects of group stop getting Box2D bodies and are tested here instead
+		void SetGroup(Tag group, bool enabled);
+		bool UsesGroup(Tag group) const { return m_Groups.Contains(group); }
+		bool HasGroups() const;
+
+		// Grid cell edge in world units, about the size of the largest projectile works best
+		void SetCellSize(float size);
+
+		void Begin();
+		// The box spans position to position + collisionBoxSize, like the Box2D body.
+		// Objects that are not projectiles are only tested against projectiles.
+		void Add(GameObject& obj, bool projectile, std::uint64_t category, std::uint64_t mask)
+		{
+			Add(obj, obj.position.x, obj.position.y, obj.collisionBoxSize.w, obj.collisionBoxSize.h, projectile, category, mask);
+		}
+		// Same with the box given, for callers that keep positions outside the object
+		void Add(GameObject& obj, float x, float y, float width, float height, bool projectile, std::uint64_t category, std::uint64_t mask);
+		// Finds this tick's overlapping pairs and adds the ones that started or ended to dispatcher
+		void Update(ContactDispatcher& dispatcher);
+		// Drops the pairs of every object about to be deleted, in one pass. They get no OnCollideExit.
+		void ForgetDestroyed();
+		// Drops every pair without callbacks, for a level change
+		void Clear();
+
+	private:
+		typedef std::pair<GameObject*, GameObject*> Pair;
+
+		void BuildGrid();
+		void FindPairs();
+
+		TagSet m_Groups;
+		float m_CellSize = 32.0f;
+
+		// One entry per added object
+		std::vector<GameObject*> m_Objects;
+		std::vector<float> m_MinX, m_MinY, m_MaxX, m_MaxY;
+		std::vector<std::uint64_t> m_Categories;
+		std::vector<std::uint64_t> m_Masks;
+		std::vector<bool> m_IsProjectile;
+		std::vector<int> m_Projectiles;
+		std::vector<int> m_LastTestedBy;
+
+		// Objects binned by cell, m_CellStart[c] to m_CellStart[c + 1] are the slots of cell c
+		float m_GridX = 0.0f, m_GridY = 0.0f, m_GridCellSize = 32.0f;
+		int m_GridWidth = 0, m_GridHeight = 0;
+		std::vector<int> m_CellStart;
+		// Next free slot of every cell while binning, kept so a tick does not allocate
+		std::vector<int> m_CellFill;
+		std::vector<int> m_SlotObject;
+		std::vector<float> m_SlotMinX, m_SlotMinY, m_SlotMaxX, m_SlotMaxY;
+		std::vector<std::uint64_t> m_SlotCategories, m_SlotMasks;
+
+		// Projectile first, in the order they were found, which follows the order objects were added.
+		// The sorted copies are only for looking pairs up, the difference between two ticks gives the events.
+		std::vector<Pair> m_Pairs;
+		std::vector<Pair> m_SortedPairs;
+		std::vector<Pair> m_PreviousPairs;
+		std::vector<Pair> m_PreviousSortedPairs;
+	};
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "RenderStats.h"
+#include "ShaderRegistry.h"
+
+class LevelBackground;
+
+namespace GameEngine {
+
+	// One sprite as the engine hands it to a backend. Position and size are in clip space.
+	// clip is -1 for sprites drawn with the fixed u0/v0/u1/v1 rect, otherwise the backend
+	// picks the frame of clip from startTime and frameDuration.
+	struct SpriteDraw
+	{
+		unsigned int texture = 0;
+		float x = 0.f, y = 0.f, w = 0.f, h = 0.f;
+		float rotation = 0.f;
+		float u0 = 0.f, v0 = 0.f, u1 = 1.f, v1 = 1.f;
+		int r = 255, g = 255, b = 255;
+
+		int clip = -1;
+		int sheetColumns = 1;
+		int sheetRows = 1;
+		float startTime = 0.f;
+		float frameDuration = 0.f;
+		bool loop = false;
+	};
+
+	// Where the engine draws to. The engine decides what is drawn and in which order,
+	// the backend owns every graphics API object and call.
+	class RenderBackend
+	{
+	public:
+		virtual ~RenderBackend() {}
+
+		// Returns false if the backend can not draw, the engine does not start then
+		virtual bool Init() = 0;
+		virtual void Shutdown() = 0;
+
+		// pixels are tightly packed RGB rows, bottom row first. Returns 0 on failure.
+		virtual unsigned int CreateTexture(const unsigned char* pixels, int width, int height) = 0;
+		virtual void DestroyTexture(unsigned int texture) = 0;
+
+		// Returns the id of a clip playing the given sheet frames in order
+		virtual int RegisterClip(const std::vector<int>& frames) = 0;
+		virtual int GetClipLength(int clip) const = 0;
+
+		virtual void CreateBackground(LevelBackground& layer) = 0;
+		virtual void DestroyBackground(LevelBackground& layer) = 0;
+
+		// time drives the animated sprites of the frame, in the same seconds as SpriteDraw::startTime
+		virtual void BeginFrame(float time) = 0;
+		virtual void DrawBackground(LevelBackground& layer, RenderStats& stats) = 0;
+		// shader is ShaderType::Sprite or ShaderType::InstancedSprite. Sprites may be held back
+		// until the next background or EndFrame, but keep their order.
+		virtual void DrawSprite(const SpriteDraw& sprite, ShaderType shader) = 0;
+		virtual void EndFrame(RenderStats& stats) = 0;
+		virtual void Present() = 0;
+
+		// Writes the last finished frame to a BMP file, false if the backend can not read its frames back
+		virtual bool SaveFrame(const std::string& path) { return false; }
+		// Returns how many pixels of the last finished frame differ from the BMP at path, -1 if it can not compare
+		virtual int CompareFrame(const std::string& path) { return -1; }
+	};
+
+}
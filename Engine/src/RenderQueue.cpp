@@ -0,0 +1,75 @@
+#include "RenderQueue.h"
+
+namespace GameEngine {
+
+	std::uint64_t RenderQueue::MakeKey(int layer, int depth, ShaderType shader, unsigned int texture)
+	{
+		return ((std::uint64_t)(layer & 0xFF) << 56)
+			| ((std::uint64_t)(depth & 0xFFFF) << 40)
+			| ((std::uint64_t)((int)shader & 0xFF) << 32)
+			| (std::uint64_t)texture;
+	}
+
+	ShaderType RenderQueue::GetShader(std::uint64_t key)
+	{
+		return (ShaderType)((key >> 32) & 0xFF);
+	}
+
+	unsigned int RenderQueue::GetTexture(std::uint64_t key)
+	{
+		return (unsigned int)(key & 0xFFFFFFFF);
+	}
+
+	void RenderQueue::Begin()
+	{
+		m_Commands.clear();
+	}
+
+	void RenderQueue::Push(std::uint64_t key, std::uint32_t payload)
+	{
+		m_Commands.push_back({ key, payload });
+	}
+
+	void RenderQueue::Sort()
+	{
+		int count = (int)m_Commands.size();
+		if (count < 2)
+			return;
+
+		m_Scratch.resize(count);
+
+		for (int shift = 0; shift < 64; shift += 8)
+		{
+			int offsets[256] = {};
+			for (const RenderCommand& command : m_Commands)
+			{
+				offsets[(command.key >> shift) & 0xFF]++;
+			}
+
+			// Every key has the same byte here, this pass would not move anything
+			if (offsets[(m_Commands[0].key >> shift) & 0xFF] == count)
+				continue;
+
+			int total = 0;
+			for (int& offset : offsets)
+			{
+				int bucketSize = offset;
+				offset = total;
+				total += bucketSize;
+			}
+
+			for (const RenderCommand& command : m_Commands)
+			{
+				m_Scratch[offsets[(command.key >> shift) & 0xFF]++] = command;
+			}
+
+			m_Commands.swap(m_Scratch);
+		}
+	}
+
+	const std::vector<RenderCommand>& RenderQueue::GetCommands() const
+	{
+		return m_Commands;
+	}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "ShaderRegistry.h"
+
+namespace GameEngine {
+
+	// One draw for this frame. What payload indexes depends on the shader in the key,
+	// a background layer for ShaderType::Background and a level object otherwise.
+	struct RenderCommand
+	{
+		std::uint64_t key;
+		std::uint32_t payload;
+	};
+
+	// Flat list of the frame's draws, sorted by a packed key before submission.
+	// From the most significant bits down the key holds layer (8), depth (16), shader (8) and texture (32),
+	// so layers draw in order, depth orders draws inside a layer and equal shader/texture runs end up next to each other.
+	class RenderQueue
+	{
+	public:
+		static std::uint64_t MakeKey(int layer, int depth, ShaderType shader, unsigned int texture);
+		static ShaderType GetShader(std::uint64_t key);
+		static unsigned int GetTexture(std::uint64_t key);
+
+		void Begin();
+		void Push(std::uint64_t key, std::uint32_t payload);
+		// Stable LSD radix sort, bytes that are equal in every key are skipped
+		void Sort();
+
+		const std::vector<RenderCommand>& GetCommands() const;
+
+	private:
+		std::vector<RenderCommand> m_Commands;
+		std::vector<RenderCommand> m_Scratch;
+	};
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+namespace GameEngine {
+
+	// Counters collected by the renderer over one frame
+	struct RenderStats
+	{
+		// Frames finished with this one, 0 before the first. Ticks of the same frame see the same value.
+		int frame = 0;
+		int drawCalls = 0;
+		int sprites = 0;
+		// Visible objects skipped because they are outside the view
+		int culledSprites = 0;
+		int renderCommands = 0;
+		// Program, vertex array and texture binds sent to GL and the ones skipped because nothing changed
+		int stateChangesIssued = 0;
+		int stateChangesElided = 0;
+		// Pixels the software backend rasterized, color keyed ones included. 0 on the GPU.
+		int pixelsFilled = 0;
+		float frameTimeMs = 0.0f;
+		float sortTimeMs = 0.0f;
+		float submitTimeMs = 0.0f;
+		// Fixed ticks run this frame and their object updates, body sync, world steps and contact callbacks
+		int physicsSteps = 0;
+		float physicsTimeMs = 0.0f;
+		// Box2D solver time over those ticks
+		float physicsSolveMs = 0.0f;
+		// Built-in systems of the EntityWorld over those ticks
+		float entityUpdateMs = 0.0f;
+		// MoverSystem integration over those ticks, before the update loop hands movers their positions
+		float moverUpdateMs = 0.0f;
+	};
+
+}
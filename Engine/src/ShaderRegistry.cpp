@@ -0,0 +1,248 @@
+#include "ShaderRegistry.h"
+
+#include <iostream>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "GLStateCache.h"
+
+namespace GameEngine {
+
+	static const char* backgroundVertexSource = R"glsl(
+		#version 330 core
+
+		in vec3 position;
+		in vec3 color;
+		in vec2 texCoord;
+
+		out vec3 Color;
+		out vec2 TexCoord;
+
+		uniform mat4 model;
+
+		void main()
+		{
+			Color = color;
+			TexCoord = texCoord;
+			gl_Position = model * vec4(position, 1.0);
+		}
+	)glsl";
+
+	static const char* spriteVertexSource = R"glsl(
+		#version 330 core
+
+		in vec2 position;
+		in vec2 texCoord;
+
+		out vec2 TexCoord;
+
+		void main()
+		{
+			TexCoord = texCoord;
+			gl_Position = vec4(position, 1.0, 1.0);
+		}
+	)glsl";
+
+	// One static unit quad, everything else comes from the per instance attributes.
+	// Animated instances look their frame up in the clip table instead of using the UV rect.
+	static const char* instancedSpriteVertexSource = R"glsl(
+		#version 330 core
+
+		in vec2 position;
+		in vec2 texCoord;
+
+		in vec4 instanceTransform; // center xy, size zw
+		in float instanceRotation; // degrees, clockwise
+		in vec4 instanceUVRect;    // bottom left uv, top right uv
+		in vec4 instanceColor;
+		in uvec4 instanceClip;     // first entry in the clip table, frame count (0 when not animated), sheet columns, sheet rows
+		in vec3 instanceTiming;    // start time, frame duration, loop
+
+		uniform float time;
+		uniform isamplerBuffer clipFrames;
+
+		out vec2 TexCoord;
+		out vec4 Tint;
+
+		void main()
+		{
+			vec4 uvRect = instanceUVRect;
+			if (instanceClip.y > 0u)
+			{
+				int frameCount = int(instanceClip.y);
+				int columns = int(instanceClip.z);
+				int step = int(floor(max(time - instanceTiming.x, 0.0) / instanceTiming.y));
+				int index = instanceTiming.z > 0.5 ? step % frameCount : min(step, frameCount - 1);
+				int frame = texelFetch(clipFrames, int(instanceClip.x) + index).r;
+
+				vec2 cell = vec2(1.0 / float(columns), 1.0 / float(instanceClip.w));
+				uvRect.xy = vec2(float(frame % columns) * cell.x, 1.0 - float(frame / columns + 1) * cell.y);
+				uvRect.zw = uvRect.xy + cell;
+			}
+
+			float angle = radians(-instanceRotation);
+			float c = cos(angle);
+			float s = sin(angle);
+
+			vec2 local = position * instanceTransform.zw;
+			vec2 rotated = vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+
+			TexCoord = mix(uvRect.xy, uvRect.zw, texCoord);
+			Tint = instanceColor;
+			gl_Position = vec4(instanceTransform.xy + rotated, 1.0, 1.0);
+		}
+	)glsl";
+
+	// Magenta is the color key of the sprite sheets
+	static const char* colorKeyFragmentSource = R"glsl(
+		#version 330 core
+		in vec2 TexCoord;
+
+		out vec4 outColor;
+
+		uniform sampler2D ourTexture;
+
+		void main()
+		{
+			vec4 colTex1 = texture(ourTexture, TexCoord);
+			if(colTex1 == vec4(1, 0, 1, 1)) discard;
+
+			outColor = colTex1;
+		})glsl";
+
+	static const char* tintedColorKeyFragmentSource = R"glsl(
+		#version 330 core
+		in vec2 TexCoord;
+		in vec4 Tint;
+
+		out vec4 outColor;
+
+		uniform sampler2D ourTexture;
+
+		void main()
+		{
+			vec4 colTex1 = texture(ourTexture, TexCoord);
+			if(colTex1 == vec4(1, 0, 1, 1)) discard;
+
+			outColor = colTex1 * Tint;
+		})glsl";
+
+	static const char* shaderNames[] = { "Background", "Sprite", "InstancedSprite" };
+
+	static GLuint CompileShader(GLenum stage, const char* source, const char* name)
+	{
+		GLuint shader = glCreateShader(stage);
+		glShaderSource(shader, 1, &source, NULL);
+		glCompileShader(shader);
+
+		GLint success;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			GLint logLength = 0;
+			glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+			std::vector<char> infoLog(logLength > 1 ? logLength : 1, '\0');
+			glGetShaderInfoLog(shader, (GLsizei)infoLog.size(), NULL, infoLog.data());
+
+			std::cout << "ERROR::SHADER::" << name << "::" << (stage == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT")
+				<< "::COMPILATION_FAILED\n" << infoLog.data() << std::endl;
+
+			glDeleteShader(shader);
+			return 0;
+		}
+		return shader;
+	}
+
+	static bool LinkProgram(ShaderProgram& program, const char* vertexSource, const char* fragmentSource, const char* name)
+	{
+		GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, vertexSource, name);
+		GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentSource, name);
+		if (vertexShader == 0 || fragmentShader == 0)
+		{
+			glDeleteShader(vertexShader);
+			glDeleteShader(fragmentShader);
+			return false;
+		}
+
+		GLuint id = glCreateProgram();
+		glAttachShader(id, vertexShader);
+		glAttachShader(id, fragmentShader);
+		glLinkProgram(id);
+
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+
+		GLint success;
+		glGetProgramiv(id, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			GLint logLength = 0;
+			glGetProgramiv(id, GL_INFO_LOG_LENGTH, &logLength);
+			std::vector<char> infoLog(logLength > 1 ? logLength : 1, '\0');
+			glGetProgramInfoLog(id, (GLsizei)infoLog.size(), NULL, infoLog.data());
+
+			std::cout << "ERROR::SHADER::" << name << "::PROGRAM::LINKING_FAILED\n" << infoLog.data() << std::endl;
+
+			glDeleteProgram(id);
+			return false;
+		}
+
+		program.id = id;
+
+		program.model = glGetUniformLocation(id, "model");
+		program.texture = glGetUniformLocation(id, "ourTexture");
+		program.time = glGetUniformLocation(id, "time");
+		program.clipFrames = glGetUniformLocation(id, "clipFrames");
+
+		program.position = glGetAttribLocation(id, "position");
+		program.color = glGetAttribLocation(id, "color");
+		program.texCoord = glGetAttribLocation(id, "texCoord");
+
+		program.instanceTransform = glGetAttribLocation(id, "instanceTransform");
+		program.instanceRotation = glGetAttribLocation(id, "instanceRotation");
+		program.instanceUVRect = glGetAttribLocation(id, "instanceUVRect");
+		program.instanceColor = glGetAttribLocation(id, "instanceColor");
+		program.instanceClip = glGetAttribLocation(id, "instanceClip");
+		program.instanceTiming = glGetAttribLocation(id, "instanceTiming");
+
+		// Every program samples its sprite sheet from texture unit 0, the animation clip table sits on unit 1
+		glState.UseProgram(id);
+		glUniform1i(program.texture, 0);
+		glUniform1i(program.clipFrames, 1);
+
+		return true;
+	}
+
+	bool ShaderRegistry::Init()
+	{
+		const char* vertexSources[] = { backgroundVertexSource, spriteVertexSource, instancedSpriteVertexSource };
+		const char* fragmentSources[] = { colorKeyFragmentSource, colorKeyFragmentSource, tintedColorKeyFragmentSource };
+
+		bool success = true;
+		for (int i = 0; i < (int)ShaderType::Count; ++i)
+		{
+			if (!LinkProgram(m_Programs[i], vertexSources[i], fragmentSources[i], shaderNames[i]))
+			{
+				success = false;
+			}
+		}
+		return success;
+	}
+
+	void ShaderRegistry::Shutdown()
+	{
+		for (ShaderProgram& program : m_Programs)
+		{
+			glState.ForgetProgram(program.id);
+			glDeleteProgram(program.id);
+			program = ShaderProgram();
+		}
+	}
+
+	const ShaderProgram& ShaderRegistry::Get(ShaderType type) const
+	{
+		return m_Programs[(int)type];
+	}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+namespace GameEngine {
+
+	enum class ShaderType
+	{
+		Background,
+		Sprite,
+		InstancedSprite,
+		Count
+	};
+
+	// A linked program with the locations the engine uses, -1 when the program does not have them
+	struct ShaderProgram
+	{
+		unsigned int id = 0;
+
+		// Uniforms
+		int model = -1;
+		int texture = -1;
+		int time = -1;
+		int clipFrames = -1;
+
+		// Attributes
+		int position = -1;
+		int color = -1;
+		int texCoord = -1;
+
+		// Per instance attributes
+		int instanceTransform = -1;
+		int instanceRotation = -1;
+		int instanceUVRect = -1;
+		int instanceColor = -1;
+		int instanceClip = -1;
+		int instanceTiming = -1;
+	};
+
+	// Compiles every engine shader once at startup and shares the programs between all users
+	class ShaderRegistry
+	{
+	public:
+		// Returns false if any program failed to compile or link, the logs are printed
+		bool Init();
+		void Shutdown();
+
+		const ShaderProgram& Get(ShaderType type) const;
+
+	private:
+		ShaderProgram m_Programs[(int)ShaderType::Count];
+	};
+
+}
@@ -0,0 +1,481 @@
+#include "SoftwareRenderBackend.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+#include <SDL.h>
+
+#include "GameLevel.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SOFTWARE_RENDER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace GameEngine {
+
+	static const std::uint32_t kClearColor = 0xFF00FFFF; // Cyan Blue, same as the GL clear
+	static const std::uint32_t kWhite = 0xFFFFFFFF;
+
+	// Texture coordinate to texel index with GL_REPEAT wrapping
+	static int WrapTexel(float coordinate, int size)
+	{
+		int texel = (int)std::floor(coordinate * size) % size;
+		return texel < 0 ? texel + size : texel;
+	}
+
+	// c * t / 255 rounded to nearest, which is what the GL unorm conversion gives
+	static std::uint32_t MulUnorm(std::uint32_t c, std::uint32_t t)
+	{
+		std::uint32_t x = c * t + 128;
+		return (x + (x >> 8)) >> 8;
+	}
+
+	static std::uint32_t Modulate(std::uint32_t texel, std::uint32_t tint)
+	{
+		return (texel & 0xFF000000)
+			| (MulUnorm((texel >> 16) & 0xFF, (tint >> 16) & 0xFF) << 16)
+			| (MulUnorm((texel >> 8) & 0xFF, (tint >> 8) & 0xFF) << 8)
+			| MulUnorm(texel & 0xFF, tint & 0xFF);
+	}
+
+	// Writes count pixels of one texel row, skipping color keyed texels like the fragment shader discard.
+	// columns holds the texel column of every pixel.
+	static void FillSpan(std::uint32_t* dst, const std::uint32_t* row, const int* columns, int count, std::uint32_t tint)
+	{
+		int i = 0;
+
+#ifdef SOFTWARE_RENDER_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+
+		if (tint == kWhite)
+		{
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i texels = _mm_set_epi32((int)row[columns[i + 3]], (int)row[columns[i + 2]], (int)row[columns[i + 1]], (int)row[columns[i]]);
+				__m128i keyed = _mm_cmpeq_epi32(_mm_and_si128(texels, alphaMask), zero);
+				__m128i old = _mm_loadu_si128((const __m128i*)(dst + i));
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(keyed, old), _mm_andnot_si128(keyed, texels)));
+			}
+		}
+		else
+		{
+			// 16 bit lanes of two pixels, B G R A each
+			const short r = (short)((tint >> 16) & 0xFF);
+			const short g = (short)((tint >> 8) & 0xFF);
+			const short b = (short)(tint & 0xFF);
+			const __m128i tintLanes = _mm_set_epi16(255, r, g, b, 255, r, g, b);
+			const __m128i half = _mm_set1_epi16(128);
+
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i texels = _mm_set_epi32((int)row[columns[i + 3]], (int)row[columns[i + 2]], (int)row[columns[i + 1]], (int)row[columns[i]]);
+				__m128i keyed = _mm_cmpeq_epi32(_mm_and_si128(texels, alphaMask), zero);
+
+				__m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(texels, zero), tintLanes), half);
+				__m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(texels, zero), tintLanes), half);
+				low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+				high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+				__m128i tinted = _mm_packus_epi16(low, high);
+
+				__m128i old = _mm_loadu_si128((const __m128i*)(dst + i));
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(keyed, old), _mm_andnot_si128(keyed, tinted)));
+			}
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			std::uint32_t texel = row[columns[i]];
+			if ((texel & 0xFF000000) == 0)
+				continue;
+			dst[i] = tint == kWhite ? texel : Modulate(texel, tint);
+		}
+	}
+
+	SoftwareRenderBackend::SoftwareRenderBackend(SDL_Window* window, int width, int height)
+		: m_Window(window), m_Width(width), m_Height(height)
+	{
+	}
+
+	bool SoftwareRenderBackend::Init()
+	{
+		if (m_Width <= 0 || m_Height <= 0)
+		{
+			std::cout << "Invalid software framebuffer size " << m_Width << "x" << m_Height << std::endl;
+			return false;
+		}
+
+		m_Pixels.assign(m_Width * m_Height, kClearColor);
+		m_Columns.resize(m_Width);
+
+		// Wraps the framebuffer without copying, for presenting and BMP files
+		m_FrameSurface = SDL_CreateRGBSurfaceWithFormatFrom(m_Pixels.data(), m_Width, m_Height, 32, m_Width * 4, SDL_PIXELFORMAT_ARGB8888);
+		if (m_FrameSurface == nullptr)
+		{
+			std::cout << "Failed to create the software framebuffer: " << SDL_GetError() << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	void SoftwareRenderBackend::Shutdown()
+	{
+		if (m_FrameSurface != nullptr)
+		{
+			SDL_FreeSurface(m_FrameSurface);
+			m_FrameSurface = nullptr;
+		}
+		m_Textures.clear();
+		m_FreeTextures.clear();
+		m_Clips.clear();
+		m_ClipFrames.clear();
+		m_ClipByFrames.clear();
+	}
+
+	unsigned int SoftwareRenderBackend::CreateTexture(const unsigned char* pixels, int width, int height)
+	{
+		if (pixels == nullptr || width <= 0 || height <= 0)
+			return 0;
+
+		Texture texture;
+		texture.width = width;
+		texture.height = height;
+		texture.texels.resize(width * height);
+		for (int i = 0; i < width * height; ++i)
+		{
+			std::uint32_t r = pixels[i * 3 + 0];
+			std::uint32_t g = pixels[i * 3 + 1];
+			std::uint32_t b = pixels[i * 3 + 2];
+			bool colorKey = r == 255 && g == 0 && b == 255;
+			texture.texels[i] = (colorKey ? 0u : 0xFF000000u) | (r << 16) | (g << 8) | b;
+		}
+
+		if (!m_FreeTextures.empty())
+		{
+			unsigned int id = m_FreeTextures.back();
+			m_FreeTextures.pop_back();
+			m_Textures[id - 1] = std::move(texture);
+			return id;
+		}
+
+		m_Textures.push_back(std::move(texture));
+		return (unsigned int)m_Textures.size();
+	}
+
+	void SoftwareRenderBackend::DestroyTexture(unsigned int texture)
+	{
+		if (FindTexture(texture) == nullptr)
+			return;
+
+		m_Textures[texture - 1] = Texture();
+		m_FreeTextures.push_back(texture);
+	}
+
+	const SoftwareRenderBackend::Texture* SoftwareRenderBackend::FindTexture(unsigned int texture) const
+	{
+		if (texture == 0 || texture > m_Textures.size() || m_Textures[texture - 1].texels.empty())
+			return nullptr;
+		return &m_Textures[texture - 1];
+	}
+
+	int SoftwareRenderBackend::RegisterClip(const std::vector<int>& frames)
+	{
+		auto found = m_ClipByFrames.find(frames);
+		if (found != m_ClipByFrames.end())
+			return found->second;
+
+		Clip clip = { (int)m_ClipFrames.size(), (int)frames.size() };
+		m_ClipFrames.insert(m_ClipFrames.end(), frames.begin(), frames.end());
+
+		int id = (int)m_Clips.size();
+		m_Clips.push_back(clip);
+		m_ClipByFrames[frames] = id;
+		return id;
+	}
+
+	int SoftwareRenderBackend::GetClipLength(int clip) const
+	{
+		if (clip < 0 || clip >= (int)m_Clips.size())
+			return 0;
+		return m_Clips[clip].length;
+	}
+
+	// Layers are drawn straight from their LevelBackground fields, there is nothing to build
+	void SoftwareRenderBackend::CreateBackground(LevelBackground& layer)
+	{
+	}
+
+	void SoftwareRenderBackend::DestroyBackground(LevelBackground& layer)
+	{
+	}
+
+	void SoftwareRenderBackend::BeginFrame(float time)
+	{
+		std::fill(m_Pixels.begin(), m_Pixels.end(), kClearColor);
+
+		m_Time = time;
+		m_PendingSprites = 0;
+		m_PixelsFilled = 0;
+	}
+
+	// Pixels are covered when their center is inside the rect, like GL rasterizes the two triangles
+	void SoftwareRenderBackend::FillRect(const Texture& texture, float x, float y, float w, float h,
+		float u0, float v0, float u1, float v1, int r, int g, int b)
+	{
+		if (w <= 0.0f || h <= 0.0f)
+			return;
+
+		float left = (x - w * 0.5f + 1.0f) * 0.5f * m_Width;
+		float right = (x + w * 0.5f + 1.0f) * 0.5f * m_Width;
+		float top = (1.0f - (y + h * 0.5f)) * 0.5f * m_Height;
+		float bottom = (1.0f - (y - h * 0.5f)) * 0.5f * m_Height;
+
+		int x0 = (std::max)((int)std::ceil(left - 0.5f), 0);
+		int x1 = (std::min)((int)std::ceil(right - 0.5f), m_Width);
+		int y0 = (std::max)((int)std::ceil(top - 0.5f), 0);
+		int y1 = (std::min)((int)std::ceil(bottom - 0.5f), m_Height);
+		if (x0 >= x1 || y0 >= y1)
+			return;
+
+		// Every row of the rect samples the same texel columns
+		float du = (u1 - u0) / (right - left);
+		for (int px = x0; px < x1; ++px)
+		{
+			m_Columns[px - x0] = WrapTexel(u0 + (px + 0.5f - left) * du, texture.width);
+		}
+
+		std::uint32_t tint = 0xFF000000 | ((std::uint32_t)r << 16) | ((std::uint32_t)g << 8) | (std::uint32_t)b;
+		float dv = (v1 - v0) / (bottom - top);
+		for (int py = y0; py < y1; ++py)
+		{
+			int texelRow = WrapTexel(v1 - (py + 0.5f - top) * dv, texture.height);
+			FillSpan(&m_Pixels[py * m_Width + x0], &texture.texels[texelRow * texture.width], m_Columns.data(), x1 - x0, tint);
+		}
+
+		m_PixelsFilled += (x1 - x0) * (y1 - y0);
+	}
+
+	// Rotation happens in clip space like the instanced vertex shader, every pixel of the
+	// bounding box is mapped back onto the unit quad
+	void SoftwareRenderBackend::FillRotatedRect(const Texture& texture, float x, float y, float w, float h, float rotation,
+		float u0, float v0, float u1, float v1, int r, int g, int b)
+	{
+		if (w <= 0.0f || h <= 0.0f)
+			return;
+
+		float angle = -rotation * 3.14159265358979f / 180.0f;
+		float c = std::cos(angle);
+		float s = std::sin(angle);
+
+		float extentX = (std::abs(w * c) + std::abs(h * s)) * 0.5f;
+		float extentY = (std::abs(w * s) + std::abs(h * c)) * 0.5f;
+
+		int x0 = (std::max)((int)std::floor((x - extentX + 1.0f) * 0.5f * m_Width), 0);
+		int x1 = (std::min)((int)std::ceil((x + extentX + 1.0f) * 0.5f * m_Width), m_Width);
+		int y0 = (std::max)((int)std::floor((1.0f - (y + extentY)) * 0.5f * m_Height), 0);
+		int y1 = (std::min)((int)std::ceil((1.0f - (y - extentY)) * 0.5f * m_Height), m_Height);
+		if (x0 >= x1 || y0 >= y1)
+			return;
+
+		std::uint32_t tint = 0xFF000000 | ((std::uint32_t)r << 16) | ((std::uint32_t)g << 8) | (std::uint32_t)b;
+		float pixelWidth = 2.0f / m_Width;
+
+		for (int py = y0; py < y1; ++py)
+		{
+			float dy = 1.0f - (py + 0.5f) * 2.0f / m_Height - y;
+			float dx = (x0 + 0.5f) * pixelWidth - 1.0f - x;
+
+			// Inverse rotation, stepped along the row
+			float localX = dx * c + dy * s;
+			float localY = -dx * s + dy * c;
+
+			std::uint32_t* dst = &m_Pixels[py * m_Width];
+			for (int px = x0; px < x1; ++px)
+			{
+				float tx = localX / w + 0.5f;
+				float ty = localY / h + 0.5f;
+				localX += pixelWidth * c;
+				localY -= pixelWidth * s;
+
+				if (tx < 0.0f || tx >= 1.0f || ty < 0.0f || ty >= 1.0f)
+					continue;
+
+				int column = WrapTexel(u0 + tx * (u1 - u0), texture.width);
+				int texelRow = WrapTexel(v0 + ty * (v1 - v0), texture.height);
+				std::uint32_t texel = texture.texels[texelRow * texture.width + column];
+				if ((texel & 0xFF000000) == 0)
+					continue;
+
+				dst[px] = tint == kWhite ? texel : Modulate(texel, tint);
+			}
+		}
+
+		m_PixelsFilled += (x1 - x0) * (y1 - y0);
+	}
+
+	// Same placement as TilemapMesh: tile (x, y) is centered on offset + (x, -y) * tile size
+	void SoftwareRenderBackend::DrawTilemap(const LevelBackground& layer, const Texture& texture)
+	{
+		int tilesX = layer.numTiles.x > 0 ? layer.numTiles.x : 1;
+		int tilesY = layer.numTiles.y > 0 ? layer.numTiles.y : 1;
+		int sheetColumns = layer.tileMapSize.columns > 0 ? layer.tileMapSize.columns : 1;
+		int sheetRows = layer.tileMapSize.rows > 0 ? layer.tileMapSize.rows : 1;
+		float tileWidth = layer.size.x;
+		float tileHeight = layer.size.y;
+		if (tileHeight <= 0.0f)
+			return;
+
+		float offsetX = layer.scrollRect.w;
+		float offsetY = layer.scrollRect.h;
+		float halfHeight = tileHeight * 0.5f;
+		int firstRow = (std::max)((int)std::ceil((offsetY - 1.0f - halfHeight) / tileHeight), 0);
+		int lastRow = (std::min)((int)std::floor((offsetY + 1.0f + halfHeight) / tileHeight), tilesY - 1);
+
+		float texWidth = 1.0f / sheetColumns;
+		float texHeight = 1.0f / sheetRows;
+
+		for (int row = firstRow; row <= lastRow; ++row)
+		{
+			for (int x = 0; x < tilesX; ++x)
+			{
+				int tileIndex = row * tilesX + x;
+				if (tileIndex >= (int)layer.tileIDs.size())
+					return;
+
+				int tileID = layer.tileIDs[tileIndex];
+				float u0 = (tileID % sheetColumns) * texWidth;
+				float v0 = 1.0f - ((tileID / sheetColumns + 1) * texHeight);
+
+				FillRect(texture, offsetX + x * tileWidth, offsetY - row * tileHeight, tileWidth, tileHeight,
+					u0, v0, u0 + texWidth, v0 + texHeight, 255, 255, 255);
+			}
+		}
+	}
+
+	void SoftwareRenderBackend::DrawBackground(LevelBackground& layer, RenderStats& stats)
+	{
+		const Texture* texture = FindTexture(layer.m_Texture);
+		if (texture == nullptr)
+			return;
+
+		if (layer.isTiled)
+		{
+			DrawTilemap(layer, *texture);
+		}
+		else
+		{
+			FillRect(*texture, layer.scrollRect.w, layer.scrollRect.h, layer.size.x, layer.size.y,
+				0.0f, 0.0f, 1.0f, 1.0f, 255, 255, 255);
+		}
+	}
+
+	// Sprites are drawn right away, submission order is already the final order
+	void SoftwareRenderBackend::DrawSprite(const SpriteDraw& sprite, ShaderType shader)
+	{
+		const Texture* texture = FindTexture(sprite.texture);
+		if (texture == nullptr)
+			return;
+
+		m_PendingSprites++;
+
+		// The batched shader has no rotation or tint
+		if (shader == ShaderType::Sprite)
+		{
+			FillRect(*texture, sprite.x, sprite.y, sprite.w, sprite.h,
+				sprite.u0, sprite.v0, sprite.u1, sprite.v1, 255, 255, 255);
+			return;
+		}
+
+		float u0 = sprite.u0, v0 = sprite.v0, u1 = sprite.u1, v1 = sprite.v1;
+		if (sprite.clip >= 0)
+		{
+			if (sprite.clip >= (int)m_Clips.size() || m_Clips[sprite.clip].length <= 0 || sprite.sheetColumns <= 0 || sprite.sheetRows <= 0 || sprite.frameDuration <= 0.0f)
+				return;
+
+			// Frame pick of the instanced vertex shader
+			const Clip& clip = m_Clips[sprite.clip];
+			int step = (int)std::floor((std::max)(m_Time - sprite.startTime, 0.0f) / sprite.frameDuration);
+			int index = sprite.loop ? step % clip.length : (std::min)(step, clip.length - 1);
+			int frame = m_ClipFrames[clip.start + index];
+
+			float cellWidth = 1.0f / sprite.sheetColumns;
+			float cellHeight = 1.0f / sprite.sheetRows;
+			u0 = (frame % sprite.sheetColumns) * cellWidth;
+			v0 = 1.0f - (frame / sprite.sheetColumns + 1) * cellHeight;
+			u1 = u0 + cellWidth;
+			v1 = v0 + cellHeight;
+		}
+
+		if (sprite.rotation != 0.0f)
+		{
+			FillRotatedRect(*texture, sprite.x, sprite.y, sprite.w, sprite.h, sprite.rotation,
+				u0, v0, u1, v1, sprite.r, sprite.g, sprite.b);
+		}
+		else
+		{
+			FillRect(*texture, sprite.x, sprite.y, sprite.w, sprite.h,
+				u0, v0, u1, v1, sprite.r, sprite.g, sprite.b);
+		}
+	}
+
+	void SoftwareRenderBackend::EndFrame(RenderStats& stats)
+	{
+		stats.sprites += m_PendingSprites;
+		stats.pixelsFilled += m_PixelsFilled;
+	}
+
+	void SoftwareRenderBackend::Present()
+	{
+		if (m_Window == nullptr)
+			return;
+
+		SDL_Surface* windowSurface = SDL_GetWindowSurface(m_Window);
+		if (windowSurface == nullptr)
+			return;
+
+		SDL_BlitScaled(m_FrameSurface, nullptr, windowSurface, nullptr);
+		SDL_UpdateWindowSurface(m_Window);
+	}
+
+	bool SoftwareRenderBackend::SaveFrame(const std::string& path)
+	{
+		return m_FrameSurface != nullptr && SDL_SaveBMP(m_FrameSurface, path.c_str()) == 0;
+	}
+
+	// Alpha is not compared, BMP files do not always keep it
+	int SoftwareRenderBackend::CompareFrame(const std::string& path)
+	{
+		SDL_Surface* loaded = SDL_LoadBMP(path.c_str());
+		if (loaded == nullptr)
+			return -1;
+
+		SDL_Surface* golden = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+		SDL_FreeSurface(loaded);
+		if (golden == nullptr)
+			return -1;
+
+		int differences = m_Width * m_Height;
+		if (golden->w == m_Width && golden->h == m_Height)
+		{
+			differences = 0;
+			for (int y = 0; y < m_Height; ++y)
+			{
+				const std::uint32_t* goldenRow = (const std::uint32_t*)((const unsigned char*)golden->pixels + y * golden->pitch);
+				const std::uint32_t* frameRow = &m_Pixels[y * m_Width];
+				for (int x = 0; x < m_Width; ++x)
+				{
+					if ((goldenRow[x] ^ frameRow[x]) & 0x00FFFFFF)
+						differences++;
+				}
+			}
+		}
+
+		SDL_FreeSurface(golden);
+		return differences;
+	}
+
+}
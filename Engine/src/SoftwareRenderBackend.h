@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "RenderBackend.h"
+
+struct SDL_Window;
+struct SDL_Surface;
+
+namespace GameEngine {
+
+	// Rasterizes every frame on the CPU into a 32 bit framebuffer. Sampling, the magenta
+	// color key, tint and the clip table animation match the GL shaders, so frames can be
+	// compared pixel for pixel. Without a window the frames are only kept for SaveFrame and CompareFrame.
+	class SoftwareRenderBackend : public RenderBackend
+	{
+	public:
+		// window may be null, width/height is the framebuffer size in pixels
+		SoftwareRenderBackend(SDL_Window* window, int width, int height);
+
+		bool Init() override;
+		void Shutdown() override;
+
+		unsigned int CreateTexture(const unsigned char* pixels, int width, int height) override;
+		void DestroyTexture(unsigned int texture) override;
+
+		int RegisterClip(const std::vector<int>& frames) override;
+		int GetClipLength(int clip) const override;
+
+		void CreateBackground(LevelBackground& layer) override;
+		void DestroyBackground(LevelBackground& layer) override;
+
+		void BeginFrame(float time) override;
+		void DrawBackground(LevelBackground& layer, RenderStats& stats) override;
+		void DrawSprite(const SpriteDraw& sprite, ShaderType shader) override;
+		void EndFrame(RenderStats& stats) override;
+		void Present() override;
+
+		bool SaveFrame(const std::string& path) override;
+		int CompareFrame(const std::string& path) override;
+
+	private:
+		// Texels are 0xAARRGGBB, the color key is stored as alpha 0 so a span can mask it in one compare
+		struct Texture
+		{
+			int width = 0;
+			int height = 0;
+			std::vector<std::uint32_t> texels; // bottom row first, like the GL upload
+		};
+
+		struct Clip
+		{
+			int start;
+			int length;
+		};
+
+		const Texture* FindTexture(unsigned int texture) const;
+
+		// x/y is the center and w/h the size in clip space, u0/v0 the bottom left texture coordinate
+		void FillRect(const Texture& texture, float x, float y, float w, float h,
+			float u0, float v0, float u1, float v1, int r, int g, int b);
+		void FillRotatedRect(const Texture& texture, float x, float y, float w, float h, float rotation,
+			float u0, float v0, float u1, float v1, int r, int g, int b);
+		void DrawTilemap(const LevelBackground& layer, const Texture& texture);
+
+		SDL_Window* m_Window = nullptr;
+		SDL_Surface* m_FrameSurface = nullptr;
+		int m_Width = 0;
+		int m_Height = 0;
+		std::vector<std::uint32_t> m_Pixels; // top row first
+		std::vector<int> m_Columns; // texel column of each pixel in the span being filled
+
+		std::vector<Texture> m_Textures; // texture id - 1
+		std::vector<unsigned int> m_FreeTextures;
+
+		std::vector<Clip> m_Clips;
+		std::vector<int> m_ClipFrames;
+		std::map<std::vector<int>, int> m_ClipByFrames;
+
+		float m_Time = 0.0f;
+		int m_PendingSprites = 0;
+		int m_PixelsFilled = 0;
+	};
+
+}
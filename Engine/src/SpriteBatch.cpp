@@ -0,0 +1,139 @@
+#include "SpriteBatch.h"
+
+#include <glad/glad.h>
+
+#include "GLStateCache.h"
+
+namespace GameEngine {
+
+	// position (2) + texture coords (2)
+	static const int kFloatsPerVertex = 4;
+	static const int kFloatsPerSprite = kFloatsPerVertex * 4;
+	static const int kInitialCapacity = 1024;
+
+	void SpriteBatch::Init(const ShaderProgram& shader)
+	{
+		m_ShaderProgram = shader.id;
+
+		glGenVertexArrays(1, &m_vao);
+		glGenBuffers(1, &m_vbo);
+		glGenBuffers(1, &m_ebo);
+
+		glState.BindVertexArray(m_vao);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+
+		glEnableVertexAttribArray(shader.position);
+		glVertexAttribPointer(shader.position, 2, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)0);
+
+		glEnableVertexAttribArray(shader.texCoord);
+		glVertexAttribPointer(shader.texCoord, 2, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)(2 * sizeof(float)));
+
+		Reserve(kInitialCapacity);
+	}
+
+	void SpriteBatch::Shutdown()
+	{
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ebo);
+		glState.ForgetVertexArray(m_vao);
+		glDeleteVertexArrays(1, &m_vao);
+
+		m_vbo = m_ebo = m_vao = m_ShaderProgram = 0;
+		m_Capacity = 0;
+	}
+
+	// Grows the vertex and index buffers so they can hold spriteCount quads.
+	// Expects the batch VAO to be bound.
+	void SpriteBatch::Reserve(int spriteCount)
+	{
+		if (spriteCount <= m_Capacity)
+			return;
+
+		int capacity = m_Capacity > 0 ? m_Capacity : kInitialCapacity;
+		while (capacity < spriteCount)
+			capacity *= 2;
+
+		std::vector<GLuint> indices(capacity * 6);
+		for (int i = 0; i < capacity; ++i)
+		{
+			GLuint first = i * 4;
+			indices[i * 6 + 0] = first + 0;
+			indices[i * 6 + 1] = first + 1;
+			indices[i * 6 + 2] = first + 3;
+			indices[i * 6 + 3] = first + 1;
+			indices[i * 6 + 4] = first + 2;
+			indices[i * 6 + 5] = first + 3;
+		}
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, capacity * kFloatsPerSprite * sizeof(float), nullptr, GL_STREAM_DRAW);
+
+		m_Capacity = capacity;
+	}
+
+	void SpriteBatch::Begin()
+	{
+		m_Sprites.clear();
+	}
+
+	void SpriteBatch::Draw(unsigned int texture, float x, float y, float w, float h, float u0, float v0, float u1, float v1)
+	{
+		m_Sprites.push_back({ texture, x, y, w, h, u0, v0, u1, v1 });
+	}
+
+	void SpriteBatch::End(RenderStats& stats)
+	{
+		if (m_Sprites.empty())
+			return;
+
+		int spriteCount = (int)m_Sprites.size();
+		m_Vertices.resize(spriteCount * kFloatsPerSprite);
+
+		float* v = m_Vertices.data();
+		for (const Sprite& s : m_Sprites)
+		{
+			float left = s.x - s.w * 0.5f;
+			float right = s.x + s.w * 0.5f;
+			float bottom = s.y - s.h * 0.5f;
+			float top = s.y + s.h * 0.5f;
+
+			// Same corner order as the single quad: top right, bottom right, bottom left, top left
+			*v++ = right; *v++ = top;    *v++ = s.u1; *v++ = s.v1;
+			*v++ = right; *v++ = bottom; *v++ = s.u1; *v++ = s.v0;
+			*v++ = left;  *v++ = bottom; *v++ = s.u0; *v++ = s.v0;
+			*v++ = left;  *v++ = top;    *v++ = s.u0; *v++ = s.v1;
+		}
+
+		glState.UseProgram(m_ShaderProgram);
+		glState.BindVertexArray(m_vao);
+
+		Reserve(spriteCount);
+
+		// Orphan last frame's storage so the driver does not stall on a buffer still in use
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, m_Capacity * kFloatsPerSprite * sizeof(float), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, m_Vertices.size() * sizeof(float), m_Vertices.data());
+
+		int first = 0;
+		while (first < spriteCount)
+		{
+			unsigned int texture = m_Sprites[first].texture;
+			int last = first + 1;
+			while (last < spriteCount && m_Sprites[last].texture == texture)
+				++last;
+
+			glState.BindTexture(0, GL_TEXTURE_2D, texture);
+			glDrawElements(GL_TRIANGLES, (last - first) * 6, GL_UNSIGNED_INT, (void*)(first * 6 * sizeof(GLuint)));
+			stats.drawCalls++;
+
+			first = last;
+		}
+
+		stats.sprites += spriteCount;
+	}
+
+}
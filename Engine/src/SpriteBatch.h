@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+
+#include "RenderStats.h"
+#include "ShaderRegistry.h"
+
+namespace GameEngine {
+
+	// Collects sprites into a single streaming vertex buffer and draws them in submission
+	// order, starting a new draw call whenever the texture changes. The RenderQueue hands
+	// sprites over already grouped by texture.
+	class SpriteBatch
+	{
+	public:
+		void Init(const ShaderProgram& shader);
+		void Shutdown();
+
+		void Begin();
+		// x/y is the sprite center and w/h its size, both in clip space.
+		// u0/v0 is the bottom left and u1/v1 the top right texture coordinate.
+		void Draw(unsigned int texture, float x, float y, float w, float h, float u0, float v0, float u1, float v1);
+		void End(RenderStats& stats);
+
+	private:
+		struct Sprite
+		{
+			unsigned int texture;
+			float x, y, w, h;
+			float u0, v0, u1, v1;
+		};
+
+		void Reserve(int spriteCount);
+
+		std::vector<Sprite> m_Sprites;
+		std::vector<float> m_Vertices;
+
+		unsigned int m_ShaderProgram = 0;
+		unsigned int m_vao = 0;
+		unsigned int m_vbo = 0;
+		unsigned int m_ebo = 0;
+		int m_Capacity = 0;
+	};
+
+}
@@ -0,0 +1,72 @@
+#include "TagRegistry.h"
+
+namespace GameEngine {
+
+	TagRegistry::TagRegistry()
+	{
+		m_IdByName[""] = 0;
+		m_Names.push_back("");
+	}
+
+	// Tags can be built during static initialization, so the registry is created on first use
+	TagRegistry& TagRegistry::Instance()
+	{
+		static TagRegistry registry;
+		return registry;
+	}
+
+	int TagRegistry::Intern(const std::string& name)
+	{
+		TagRegistry& registry = Instance();
+		auto found = registry.m_IdByName.find(name);
+		if (found != registry.m_IdByName.end())
+			return found->second;
+
+		int id = (int)registry.m_Names.size();
+		registry.m_IdByName[name] = id;
+		registry.m_Names.push_back(name);
+		return id;
+	}
+
+	const std::string& TagRegistry::GetName(int id)
+	{
+		return Instance().m_Names[id];
+	}
+
+	int TagRegistry::GetCount()
+	{
+		return (int)Instance().m_Names.size();
+	}
+
+	TagSet::TagSet(std::initializer_list<Tag> tags)
+	{
+		for (Tag tag : tags)
+			Add(tag);
+	}
+
+	void TagSet::Add(Tag tag)
+	{
+		std::size_t word = (std::size_t)tag.GetId() / 64;
+		if (word >= m_Bits.size())
+			m_Bits.resize(word + 1, 0);
+		m_Bits[word] |= std::uint64_t(1) << (tag.GetId() % 64);
+	}
+
+	void TagSet::Remove(Tag tag)
+	{
+		std::size_t word = (std::size_t)tag.GetId() / 64;
+		if (word < m_Bits.size())
+			m_Bits[word] &= ~(std::uint64_t(1) << (tag.GetId() % 64));
+	}
+
+	bool TagSet::IsEmpty() const
+	{
+		for (std::uint64_t bits : m_Bits)
+		{
+			if (bits != 0)
+				return false;
+		}
+		return true;
+	}
+
+}
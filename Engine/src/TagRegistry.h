@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GameEngine {
+
+	// Interns names like object groups into small dense ids, 0 is the empty name.
+	// Interning happens when a Tag is built from a name, everything after that works on the id.
+	// Not thread safe, names are meant to be interned by game code on the main thread.
+	class TagRegistry
+	{
+	public:
+		static int Intern(const std::string& name);
+		// The name behind id, for logs and debugging
+		static const std::string& GetName(int id);
+		static int GetCount();
+
+	private:
+		TagRegistry();
+		static TagRegistry& Instance();
+
+		std::unordered_map<std::string, int> m_IdByName;
+		std::vector<std::string> m_Names;
+	};
+
+	// An interned name. Copying and comparing only touch the id.
+	class Tag
+	{
+	public:
+		Tag() {}
+		Tag(const char* name) : m_Id(TagRegistry::Intern(name)) {}
+		Tag(const std::string& name) : m_Id(TagRegistry::Intern(name)) {}
+
+		int GetId() const { return m_Id; }
+		const std::string& GetName() const { return TagRegistry::GetName(m_Id); }
+
+		bool operator==(Tag other) const { return m_Id == other.m_Id; }
+		bool operator!=(Tag other) const { return m_Id != other.m_Id; }
+
+	private:
+		int m_Id = 0;
+	};
+
+	// Membership of tags as a bitmask over their ids, like "every hostile group"
+	class TagSet
+	{
+	public:
+		TagSet() {}
+		TagSet(std::initializer_list<Tag> tags);
+
+		void Add(Tag tag);
+		void Remove(Tag tag);
+		bool Contains(Tag tag) const
+		{
+			std::size_t word = (std::size_t)tag.GetId() / 64;
+			return word < m_Bits.size() && (m_Bits[word] >> (tag.GetId() % 64) & 1) != 0;
+		}
+		bool IsEmpty() const;
+
+	private:
+		std::vector<std::uint64_t> m_Bits;
+	};
+
+}
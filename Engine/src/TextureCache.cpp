@@ -0,0 +1,110 @@
+#include "TextureCache.h"
+
+#include <iostream>
+
+#include "RenderBackend.h"
+#include "stb_image.h"
+
+namespace GameEngine {
+
+	void TextureCache::SetBackend(RenderBackend* backend)
+	{
+		m_Backend = backend;
+	}
+
+	unsigned int TextureCache::Acquire(const std::string& path)
+	{
+		auto found = m_Entries.find(path);
+		if (found != m_Entries.end())
+		{
+			// Failed paths stay cached as texture 0 without references, they are not loaded or logged again
+			if (found->second.texture != 0)
+				found->second.refCount++;
+			m_Stats.hits++;
+			return found->second.texture;
+		}
+
+		m_Stats.misses++;
+
+		stbi_set_flip_vertically_on_load(true);
+
+		int width, height, nrChannels;
+		unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 3);
+		if (!data)
+		{
+			std::cout << "Failed to load texture " << path << std::endl;
+			m_Entries[path] = Entry();
+			return 0;
+		}
+
+		Entry entry;
+		entry.texture = m_Backend != nullptr ? m_Backend->CreateTexture(data, width, height) : 0;
+
+		stbi_image_free(data);
+
+		if (entry.texture == 0)
+		{
+			std::cout << "Failed to create texture " << path << std::endl;
+			m_Entries[path] = Entry();
+			return 0;
+		}
+
+		// Base level plus the whole mip chain
+		for (int w = width, h = height; ; w = w > 1 ? w / 2 : 1, h = h > 1 ? h / 2 : 1)
+		{
+			entry.bytes += (std::size_t)w * h * 3;
+			if (w == 1 && h == 1)
+				break;
+		}
+		entry.refCount = 1;
+
+		m_Entries[path] = entry;
+		m_PathByTexture[entry.texture] = path;
+
+		m_Stats.residentTextures++;
+		m_Stats.residentBytes += entry.bytes;
+
+		return entry.texture;
+	}
+
+	void TextureCache::Release(unsigned int texture)
+	{
+		auto path = m_PathByTexture.find(texture);
+		if (path == m_PathByTexture.end())
+			return;
+
+		auto found = m_Entries.find(path->second);
+		if (--found->second.refCount > 0)
+			return;
+
+		if (m_Backend != nullptr)
+			m_Backend->DestroyTexture(found->second.texture);
+
+		m_Stats.residentTextures--;
+		m_Stats.residentBytes -= found->second.bytes;
+
+		m_Entries.erase(found);
+		m_PathByTexture.erase(path);
+	}
+
+	void TextureCache::Clear()
+	{
+		for (auto& entry : m_Entries)
+		{
+			if (m_Backend != nullptr && entry.second.texture != 0)
+				m_Backend->DestroyTexture(entry.second.texture);
+		}
+
+		m_Entries.clear();
+		m_PathByTexture.clear();
+
+		m_Stats.residentTextures = 0;
+		m_Stats.residentBytes = 0;
+	}
+
+	const TextureCache::Stats& TextureCache::GetStats() const
+	{
+		return m_Stats;
+	}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+namespace GameEngine {
+
+	class RenderBackend;
+
+	// Decodes and uploads every image path once and shares the backend texture between
+	// all of its users. A texture is deleted when its last user releases it.
+	class TextureCache
+	{
+	public:
+		struct Stats
+		{
+			int hits = 0;
+			int misses = 0;
+			int residentTextures = 0;
+			std::size_t residentBytes = 0;
+		};
+
+		// Textures are created in and deleted from backend, which has to outlive them
+		void SetBackend(RenderBackend* backend);
+
+		// Returns the texture for path and adds one reference to it, 0 if the image could not be loaded.
+		// A path that failed once keeps returning 0 until Clear.
+		unsigned int Acquire(const std::string& path);
+		// Drops one reference, the texture is deleted once nobody uses it anymore
+		void Release(unsigned int texture);
+		void Clear();
+
+		const Stats& GetStats() const;
+
+	private:
+		struct Entry
+		{
+			unsigned int texture = 0;
+			int refCount = 0;
+			std::size_t bytes = 0;
+		};
+
+		std::unordered_map<std::string, Entry> m_Entries;
+		std::unordered_map<unsigned int, std::string> m_PathByTexture;
+		Stats m_Stats;
+		RenderBackend* m_Backend = nullptr;
+	};
+
+}
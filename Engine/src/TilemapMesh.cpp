@@ -0,0 +1,155 @@
+#include "TilemapMesh.h"
+
+#include <cmath>
+
+#include <glad/glad.h>
+
+#include "GLStateCache.h"
+
+namespace GameEngine {
+
+	// Same layout as the background quad: position (3) + color (3) + texture coords (2)
+	static const int kFloatsPerVertex = 8;
+	static const int kFloatsPerTile = kFloatsPerVertex * 4;
+
+	void TilemapMesh::Build(const ShaderProgram& shader, int tilesX, int tilesY, int sheetColumns, int sheetRows, const std::vector<int>& tileIDs)
+	{
+		m_TilesX = tilesX > 0 ? tilesX : 1;
+		m_TilesY = tilesY > 0 ? tilesY : 1;
+		m_SheetColumns = sheetColumns > 0 ? sheetColumns : 1;
+		m_SheetRows = sheetRows > 0 ? sheetRows : 1;
+		m_TileIDs = tileIDs;
+		m_RowUploaded.assign(m_TilesY, false);
+		m_RowVertices.resize(m_TilesX * kFloatsPerTile);
+
+		int tileCount = m_TilesX * m_TilesY;
+
+		std::vector<GLuint> indices(tileCount * 6);
+		for (int i = 0; i < tileCount; ++i)
+		{
+			GLuint first = i * 4;
+			indices[i * 6 + 0] = first + 0;
+			indices[i * 6 + 1] = first + 1;
+			indices[i * 6 + 2] = first + 3;
+			indices[i * 6 + 3] = first + 1;
+			indices[i * 6 + 4] = first + 2;
+			indices[i * 6 + 5] = first + 3;
+		}
+
+		glGenVertexArrays(1, &m_vao);
+		glGenBuffers(1, &m_vbo);
+		glGenBuffers(1, &m_ebo);
+
+		glState.BindVertexArray(m_vao);
+
+		// Storage for every cell up front, rows are filled in as they come into view
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, tileCount * kFloatsPerTile * sizeof(float), nullptr, GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+		glEnableVertexAttribArray(shader.position);
+		glVertexAttribPointer(shader.position, 3, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)0);
+
+		glEnableVertexAttribArray(shader.color);
+		glVertexAttribPointer(shader.color, 3, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)(3 * sizeof(float)));
+
+		glEnableVertexAttribArray(shader.texCoord);
+		glVertexAttribPointer(shader.texCoord, 2, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)(6 * sizeof(float)));
+	}
+
+	void TilemapMesh::Destroy()
+	{
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ebo);
+		glState.ForgetVertexArray(m_vao);
+		glDeleteVertexArrays(1, &m_vao);
+
+		m_vbo = m_ebo = m_vao = 0;
+		m_RowUploaded.clear();
+	}
+
+	bool TilemapMesh::IsBuilt() const
+	{
+		return m_vao != 0;
+	}
+
+	// Writes the quads of one row, expects the mesh VBO to be bound
+	void TilemapMesh::UploadRow(int row)
+	{
+		float texWidth = 1.0f / m_SheetColumns;
+		float texHeight = 1.0f / m_SheetRows;
+
+		float* v = m_RowVertices.data();
+		for (int x = 0; x < m_TilesX; ++x)
+		{
+			int tileIndex = row * m_TilesX + x;
+
+			float left = x - 0.5f;
+			float right = x + 0.5f;
+			float bottom = -row - 0.5f;
+			float top = -row + 0.5f;
+
+			// Empty cells collapse to a point so they rasterize nothing
+			if (tileIndex >= (int)m_TileIDs.size())
+			{
+				left = right = (float)x;
+				bottom = top = (float)-row;
+			}
+
+			int tileID = tileIndex < (int)m_TileIDs.size() ? m_TileIDs[tileIndex] : 0;
+			int column = tileID % m_SheetColumns;
+			int sheetRow = tileID / m_SheetColumns;
+
+			float u0 = column * texWidth;
+			float v0 = 1.0f - ((sheetRow + 1) * texHeight);
+			float u1 = u0 + texWidth;
+			float v1 = v0 + texHeight;
+
+			// top right, bottom right, bottom left, top left
+			*v++ = right; *v++ = top;    *v++ = 0.f; *v++ = 0.f; *v++ = 0.f; *v++ = 0.f; *v++ = u1; *v++ = v1;
+			*v++ = right; *v++ = bottom; *v++ = 0.f; *v++ = 0.f; *v++ = 0.f; *v++ = 0.f; *v++ = u1; *v++ = v0;
+			*v++ = left;  *v++ = bottom; *v++ = 0.f; *v++ = 0.f; *v++ = 0.f; *v++ = 0.f; *v++ = u0; *v++ = v0;
+			*v++ = left;  *v++ = top;    *v++ = 0.f; *v++ = 0.f; *v++ = 0.f; *v++ = 0.f; *v++ = u0; *v++ = v1;
+		}
+
+		GLintptr rowBytes = m_TilesX * kFloatsPerTile * sizeof(float);
+		glBufferSubData(GL_ARRAY_BUFFER, row * rowBytes, rowBytes, m_RowVertices.data());
+
+		m_RowUploaded[row] = true;
+	}
+
+	void TilemapMesh::Draw(float offsetY, float tileHeight, RenderStats& stats)
+	{
+		if (!IsBuilt() || tileHeight <= 0.0f)
+			return;
+
+		// Rows whose quad overlaps the [-1, 1] clip range
+		float halfHeight = tileHeight * 0.5f;
+		int firstRow = (int)std::ceil((offsetY - 1.0f - halfHeight) / tileHeight);
+		int lastRow = (int)std::floor((offsetY + 1.0f + halfHeight) / tileHeight);
+
+		if (firstRow < 0)
+			firstRow = 0;
+		if (lastRow > m_TilesY - 1)
+			lastRow = m_TilesY - 1;
+		if (firstRow > lastRow)
+			return;
+
+		glState.BindVertexArray(m_vao);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+
+		for (int row = firstRow; row <= lastRow; ++row)
+		{
+			if (!m_RowUploaded[row])
+				UploadRow(row);
+		}
+
+		int firstTile = firstRow * m_TilesX;
+		int tileCount = (lastRow - firstRow + 1) * m_TilesX;
+		glDrawElements(GL_TRIANGLES, tileCount * 6, GL_UNSIGNED_INT, (void*)(firstTile * 6 * sizeof(GLuint)));
+		stats.drawCalls++;
+	}
+
+}
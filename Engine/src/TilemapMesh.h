@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+
+#include "RenderStats.h"
+#include "ShaderRegistry.h"
+
+namespace GameEngine {
+
+	// One static mesh holding every cell of a tiled background layer. Rows are written
+	// the first time they scroll into view and the visible rows go out in a single draw,
+	// the layer position itself comes from the model uniform.
+	class TilemapMesh
+	{
+	public:
+		// tilesX/tilesY is the layer size in tiles, sheetColumns/sheetRows the tile sheet layout.
+		// Cells without an entry in tileIDs stay empty.
+		void Build(const ShaderProgram& shader, int tilesX, int tilesY, int sheetColumns, int sheetRows, const std::vector<int>& tileIDs);
+		void Destroy();
+		bool IsBuilt() const;
+
+		// Tile (x, y) is a unit quad centered on (x, -y) in mesh space, so with the model
+		// uniform set to translate(offset) * scale(tileSize) row y is centered on offsetY - y * tileHeight.
+		// Expects the texture and the program with that uniform to be bound.
+		void Draw(float offsetY, float tileHeight, RenderStats& stats);
+
+	private:
+		void UploadRow(int row);
+
+		std::vector<int> m_TileIDs;
+		std::vector<bool> m_RowUploaded;
+		std::vector<float> m_RowVertices;
+
+		int m_TilesX = 0;
+		int m_TilesY = 0;
+		int m_SheetColumns = 1;
+		int m_SheetRows = 1;
+
+		unsigned int m_vao = 0;
+		unsigned int m_vbo = 0;
+		unsigned int m_ebo = 0;
+	};
+
+}
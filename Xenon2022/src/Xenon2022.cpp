@@ -1,7 +1,11 @@
 #include "Engine.h"
+#include "ObjectPool.h"
 #include <random>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -12,26 +16,68 @@
 GameEngine::Engine engine;
 float globalRotation = 0.0f;
 
+// Every heap allocation of the process, the stress scene prints them per frame to check that
+// pooled spawns and the engine's tick do not allocate. Array new goes through these as well.
+// Only built with XENON_COUNT_ALLOCATIONS defined, the game itself keeps the default operators.
+#ifdef XENON_COUNT_ALLOCATIONS
+std::atomic<long long> heapAllocations{ 0 };
+
+void* operator new(std::size_t size) {
+	heapAllocations++;
+	if (void* memory = std::malloc(size > 0 ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+	std::free(memory);
+}
+#endif
+
 //To use this fuction we just call *GetGlobalRotation() and get the value of the global rotation
 float* GetGlobalRotation() {
 	return &globalRotation;
 }
 
-template <typename T>
-void removeNullPointers(std::vector<T>& vec) {
-	vec.erase(std::remove_if(vec.begin(), vec.end(), [](T ptr) { return ptr == nullptr; }), vec.end());
+// Drops the handles of objects that are no longer in the level
+void removeDeadHandles(std::vector<GameEngine::EntityHandle>& handles) {
+	handles.erase(std::remove_if(handles.begin(), handles.end(),
+		[](GameEngine::EntityHandle handle) { return engine.getObject(handle) == nullptr; }), handles.end());
 }
 
+// Reseeded in main for runs that have to play out the same every time
+std::default_random_engine randomEngine{ std::random_device{}() };
+
 float getRandomFloat(float min, float max) {
-	static std::default_random_engine engine{ std::random_device{}() };
 	std::uniform_real_distribution<float> distribution(min, max);
-	return distribution(engine);
+	return distribution(randomEngine);
 }
 
 int getRandomInt(int min, int max) {
-	static std::default_random_engine engine{ std::random_device{}() };
 	std::uniform_real_distribution<float> distribution(min, max);
-	return distribution(engine);
+	return distribution(randomEngine);
+}
+
+// Object groups interned once, so setting one in OnStart does not build a string on every respawn
+namespace groups {
+	static const GameEngine::Tag powerUpMissile("powerUpMissile");
+	static const GameEngine::Tag powerUpHeal("powerUpHeal");
+	static const GameEngine::Tag powerUpCompanion("powerUpCompanion");
+	static const GameEngine::Tag bullet("bullet");
+	static const GameEngine::Tag enemy("enemy");
+	static const GameEngine::Tag enemyBullet("enemyBullet");
+	static const GameEngine::Tag MASpwaner("MASpwaner");
+	static const GameEngine::Tag SASpwaner("SASpwaner");
+	static const GameEngine::Tag companion("companion");
+	static const GameEngine::Tag player("player");
+	static const GameEngine::Tag RSpwaner("RSpwaner");
+	static const GameEngine::Tag LSpwaner("LSpwaner");
+	static const GameEngine::Tag stress("stress");
+	static const GameEngine::Tag bench("bench");
 }
 
 class powerUpMissile : public GameObject {
@@ -46,21 +92,17 @@ public:
 	void OnStart() override {
 		int textureDimentions[2] = { 4,2 };
 
-		animation = new Animation("resources/graphics/PUWeapon.bmp", 0.1f, textureDimentions, true, {});
-		objectGroup = "powerUpMissile";
+		if (animation == nullptr)
+			animation = new Animation("resources/graphics/PUWeapon.bmp", 0.1f, textureDimentions, true, {});
+		objectGroup = groups::powerUpMissile;
 		collisionBoxSize.w = 32.0f;
 		collisionBoxSize.h = 32.0f;
 
 		rotation = *GetGlobalRotation();
 
-	}
-
-	void OnUpdate() override {
-		position.y -= moveSpeed * engine.deltaTime;
-
-		if (position.y < -280) {
-			Destroy();
-		}
+		mover.enabled = true;
+		mover.velocityY = -moveSpeed;
+		mover.minY = -280.f;
 	}
 
 };
@@ -77,17 +119,13 @@ public:
 	void OnStart() override {
 		int textureDimentions[2] = { 4,2 };
 
-		animation = new Animation("resources/graphics/PUShield.bmp", 0.1f, textureDimentions, true, {});
-		objectGroup = "powerUpHeal";
-
-	}
-
-	void OnUpdate() override {
-		position.y -= moveSpeed * engine.deltaTime;
+		if (animation == nullptr)
+			animation = new Animation("resources/graphics/PUShield.bmp", 0.1f, textureDimentions, true, {});
+		objectGroup = groups::powerUpHeal;
 
-		if (position.y < -280) {
-			Destroy();
-		}
+		mover.enabled = true;
+		mover.velocityY = -moveSpeed;
+		mover.minY = -280.f;
 	}
 
 };
@@ -103,22 +141,25 @@ public:
 	void OnStart() override {
 		int textureDimentions[2] = { 4,5 };
 
-		animation = new Animation("resources/graphics/clone.bmp", 0.1f, textureDimentions, true, { 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15});
-		objectGroup = "powerUpCompanion";
+		if (animation == nullptr)
+			animation = new Animation("resources/graphics/clone.bmp", 0.1f, textureDimentions, true, { 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15});
+		objectGroup = groups::powerUpCompanion;
 
+		mover.enabled = true;
+		mover.velocityY = -moveSpeed;
+		mover.minY = -280.f;
 	}
 
-	void OnUpdate() override {
-
-		position.y -= moveSpeed * engine.deltaTime;
+};
 
-		if (position.y < -280) {
-			Destroy();
-		}
-	}
+// Power-ups, bullets and explosions come and go all the time, so they are recycled instead of deleted
+GameEngine::ObjectPool<powerUpMissile> powerUpMissilePool;
+GameEngine::ObjectPool<powerUpHeal> powerUpHealPool;
+GameEngine::ObjectPool<powerUpCompanion> powerUpCompanionPool;
 
-};
+class missile;
 
+// Every object of the "enemy" group is an Enemy, the bullet handler relies on it
 class Enemy : public GameObject {
 public:
 	Enemy(bool visibility = true, bool isBullet = false, bool hasSense = false)
@@ -128,6 +169,8 @@ public:
 	int healthPoints = 1;
 	float dropChance = 10.f;
 
+	virtual void OnMissileHit(missile& bullet) {}
+
 	void showDamageFeedback() {
 		modulate.r = 255;
 		modulate.g = 0;
@@ -178,17 +221,17 @@ public:
 				{
 				case 0:
 
-					CreatePowerUp(new powerUpHeal(true, true, true), position.x, position.y);
+					CreatePowerUp(powerUpHealPool.Spawn(), position.x, position.y);
 
 					break;
 				case 1:
 
-					CreatePowerUp(new powerUpMissile(true, true, true), position.x, position.y);
+					CreatePowerUp(powerUpMissilePool.Spawn(), position.x, position.y);
 
 					break;
 				case 2:
 
-					CreatePowerUp(new powerUpCompanion(true, true, true), position.x, position.y);
+					CreatePowerUp(powerUpCompanionPool.Spawn(), position.x, position.y);
 
 					break;
 				default:
@@ -220,7 +263,9 @@ public:
 
 		int textureDimentions[2] = { 5,2 };
 
-		animation = new Animation("resources/graphics/explode64.bmp", 0.1f, textureDimentions, false, {});
+		if (animation == nullptr)
+			animation = new Animation("resources/graphics/explode64.bmp", 0.1f, textureDimentions, false, {});
+		renderLayer = RenderLayer::Effects;
 	}
 
 	void OnAnimationFinish() override {
@@ -229,6 +274,8 @@ public:
 
 };
 
+GameEngine::ObjectPool<explosion> explosionPool;
+
 class missile : public GameObject {
 public:
 
@@ -240,29 +287,39 @@ public:
 
 	int firePower = 0;
 	int missileDamage = 1;
+	// Fire power the animation was made for, a recycled missile keeps its animation while it matches
+	int animatedFirePower = -1;
 
 	void OnStart() override {
 		int textureDimentions[2] = { 2,3 };
-		switch (firePower) {
-		case 0:
-			animation = new Animation("resources/graphics/missile.bmp", 0.1f, textureDimentions, true, { 0 ,1});
-			break;
-		case 1:
-			animation = new Animation("resources/graphics/missile.bmp", 0.1f, textureDimentions, true, {2,3});
-			break;
-		case 2:
-			animation = new Animation("resources/graphics/missile.bmp", 0.1f, textureDimentions, true, { 4,5 });
-			break;
-		default:
-			animation = new Animation("resources/graphics/missile.bmp", 0.1f, textureDimentions, true, {0, 1});
-			break;
+		if (animation == nullptr || animatedFirePower != firePower) {
+			switch (firePower) {
+			case 0:
+				animation = new Animation("resources/graphics/missile.bmp", 0.1f, textureDimentions, true, { 0 ,1});
+				break;
+			case 1:
+				animation = new Animation("resources/graphics/missile.bmp", 0.1f, textureDimentions, true, {2,3});
+				break;
+			case 2:
+				animation = new Animation("resources/graphics/missile.bmp", 0.1f, textureDimentions, true, { 4,5 });
+				break;
+			default:
+				animation = new Animation("resources/graphics/missile.bmp", 0.1f, textureDimentions, true, {0, 1});
+				break;
+			}
+			animatedFirePower = firePower;
 		}
 
 		collisionBoxSize.w = collisionBoxSize.h = 16.0f;
 
-		objectGroup = "bullet";
+		objectGroup = groups::bullet;
+		renderLayer = RenderLayer::Bullets;
 
 		rotation = *GetGlobalRotation();
+
+		mover.enabled = true;
+		mover.velocityY = moveSpeed;
+		mover.maxY = 250.f;
 	}
 
 	int getMissileDamage() {
@@ -282,15 +339,11 @@ public:
 		return damage;
 	}
 
-	void OnUpdate() override {
-		position.y += moveSpeed * engine.deltaTime;
-		
-		if (position.y > 250) {
-			Destroy();
-		}
-	}
+
 };
 
+GameEngine::ObjectPool<missile> missilePool;
+
 class rusher : public Enemy {
 public:
 
@@ -305,39 +358,32 @@ public:
 		int textureDimentions[2] = { 4,6 };
 
 		animation = new Animation("resources/graphics/rusher.bmp", 0.05f, textureDimentions, true, {});
-		objectGroup = "enemy";
+		objectGroup = groups::enemy;
 		collisionBoxSize.w = 48.0f;
 		collisionBoxSize.h = 32.0f;
 
 		rotation = *GetGlobalRotation();
+
+		// Moved by the engine, OnUpdate only flashes the damage feedback
+		mover.enabled = true;
+		mover.callUpdate = true;
+		mover.velocityY = -moveSpeed;
+		mover.minY = -300.f;
 	}
 
 	void OnUpdate() override {
-		position.y -= moveSpeed * engine.deltaTime;
-
-		if (position.y < -300) {
-			Destroy();
-		}
-
 		checkDamageFeedback();
 	}
 
-	void OnCollideEnter(GameObject& contact) override {
-		if (contact.objectGroup == "bullet") {
-
-			explosion* boom = new explosion();
-			boom->position.x = position.x;
-			boom->position.y = position.y;
-			engine.getLevel().addObject(boom);
-
-			if (missile* missileContact = dynamic_cast<missile*>(&contact)) {
+	void OnMissileHit(missile& bullet) override {
+		explosion* boom = explosionPool.Spawn();
+		boom->position.x = position.x;
+		boom->position.y = position.y;
+		engine.getLevel().addObject(boom);
 
-				int missileFirePower = missileContact->getMissileDamage();
-				TakeDamage(missileFirePower);
-			}
+		TakeDamage(bullet.getMissileDamage());
 
-			contact.Destroy();
-		}
+		bullet.Destroy();
 	}
 
 };
@@ -353,22 +399,22 @@ public:
 	void OnStart() override {
 		int textureDimentions[2] = { 8,1 };
 
-		animation = new Animation("resources/graphics/EnWeap6.bmp", 0.1f, textureDimentions, true, {});
-		objectGroup = "enemyBullet";
+		if (animation == nullptr)
+			animation = new Animation("resources/graphics/EnWeap6.bmp", 0.1f, textureDimentions, true, {});
+		objectGroup = groups::enemyBullet;
+		renderLayer = RenderLayer::Bullets;
 
 		collisionBoxSize.w = collisionBoxSize.h = 16.0f;
-	}
-
-	void OnUpdate() override {
-		position.y -= moveSpeed * engine.deltaTime;
 
-		if (position.y < -280.f) {
-			Destroy();
-		}
+		mover.enabled = true;
+		mover.velocityY = -moveSpeed;
+		mover.minY = -280.f;
 	}
 
 };
 
+GameEngine::ObjectPool<enemyProjectile> enemyProjectilePool;
+
 class loner : public Enemy {
 public:
 
@@ -387,35 +433,27 @@ public:
 		int textureDimentions[2] = { 4,4 };
 
 		animation = new Animation("resources/graphics/LonerA.bmp", 0.05f, textureDimentions, true, {});
-		objectGroup = "enemy";
+		objectGroup = groups::enemy;
 
 		collisionBoxSize.w = collisionBoxSize.h = 64.0f;
 		rotation = *GetGlobalRotation();
 	}
 
-	void OnCollideEnter(GameObject& contact) override {
-		if (contact.objectGroup == "bullet") {
-
-			explosion* boom = new explosion(true, false, false);
+	void OnMissileHit(missile& bullet) override {
+		explosion* boom = explosionPool.Spawn();
 
-			boom->position.x = position.x;
-			boom->position.y = position.y;
-			engine.getLevel().addObject(boom);
+		boom->position.x = position.x;
+		boom->position.y = position.y;
+		engine.getLevel().addObject(boom);
 
-			if (missile* missileContact = dynamic_cast<missile*>(&contact)) {
-
-				int missileFirePower = missileContact->getMissileDamage();
-
-				TakeDamage(missileFirePower);
-			}
-			contact.Destroy();
-		}
+		TakeDamage(bullet.getMissileDamage());
+		bullet.Destroy();
 	}
 	void OnUpdate() override {
 		time += 1 * engine.deltaTime;
 
 		if (time > timeCooldown) {
-			enemyProjectile* enemyProj = new enemyProjectile();
+			enemyProjectile* enemyProj = enemyProjectilePool.Spawn();
 			enemyProj->position.x = position.x - 10;
 			enemyProj->position.y = position.y - 35;
 			engine.getLevel().addObject(enemyProj);
@@ -434,11 +472,12 @@ public:
 
 };
 
-class metalAsteroid : public GameObject {
+// Indestructible, it only swallows bullets
+class metalAsteroid : public Enemy {
 public:
 
 	metalAsteroid(bool visibility = true, bool isBullet = true, bool hasSense = true)
-		: GameObject(visibility, isBullet, hasSense) {
+		: Enemy(visibility, isBullet, hasSense) {
 	}
 	std::vector<int> asteroidTypes = {32, 64, 96};
 	float moveSpeed = 60.0f;
@@ -448,7 +487,7 @@ public:
 
 		int textureDimentions[2] = { 8,2 };
 
-		objectGroup = "enemy";
+		objectGroup = groups::enemy;
 
 		switch (asteroidSize) {
 		case 64:
@@ -469,24 +508,14 @@ public:
 
 		collisionBoxSize.w = collisionBoxSize.h = asteroidSize;
 		rotation = globalRotation;
-	}
-
-	void OnUpdate() override {
-		position.y -= moveSpeed * engine.deltaTime;
-
-		if (position.y < -300) {
-			Destroy();
-
-		}
 
+		mover.enabled = true;
+		mover.velocityY = -moveSpeed;
+		mover.minY = -300.f;
 	}
 
-	void OnCollideEnter(GameObject& contact) override {
-
-		if (contact.objectGroup == "bullet") {
-			contact.Destroy();
-
-		}
+	void OnMissileHit(missile& bullet) override {
+		bullet.Destroy();
 	}
 
 
@@ -510,7 +539,7 @@ public:
 
 		int textureDimentions[2];
 
-		objectGroup = "enemy";
+		objectGroup = groups::enemy;
 
 		switch (asteroidSize) {
 		case 64:
@@ -590,23 +619,14 @@ public:
 
 	}
 
-	void OnCollideEnter(GameObject& contact) override {
-
-		if (contact.objectGroup == "bullet") {
-
-			if (missile* missileContact = dynamic_cast<missile*>(&contact)) {
+	void OnMissileHit(missile& bullet) override {
+		bullet.Destroy();
+		TakeDamage(bullet.getMissileDamage());
 
-				int missileFirePower = missileContact->getMissileDamage();
-				contact.Destroy();
-				TakeDamage(missileFirePower);
-			}
-
-			explosion* boom = new explosion();
-			boom->position.x = position.x;
-			boom->position.y = position.y;
-			engine.getLevel().addObject(boom);
-
-		}
+		explosion* boom = explosionPool.Spawn();
+		boom->position.x = position.x;
+		boom->position.y = position.y;
+		engine.getLevel().addObject(boom);
 	}
 };
 
@@ -632,7 +652,7 @@ public:
 		int textureDimentions[2] = { 8,2 };
 
 		animation = new Animation("resources/graphics/drone.bmp", 0.1f, textureDimentions, true, {});
-		objectGroup = "enemy";
+		objectGroup = groups::enemy;
 
 
 	}
@@ -653,24 +673,15 @@ public:
 
 	}
 
-	void OnCollideEnter(GameObject& contact) override {
-		if (contact.objectGroup == "bullet") {
-
-			explosion* boom = new explosion();
-			boom->position.x = position.x;
-			boom->position.y = position.y;
-			engine.getLevel().addObject(boom);
+	void OnMissileHit(missile& bullet) override {
+		explosion* boom = explosionPool.Spawn();
+		boom->position.x = position.x;
+		boom->position.y = position.y;
+		engine.getLevel().addObject(boom);
 
-			if (missile* missileContact = dynamic_cast<missile*>(&contact)) {
+		TakeDamage(bullet.getMissileDamage());
 
-				int missileFirePower = missileContact->getMissileDamage();
-
-				TakeDamage(missileFirePower);
-			}
-
-			contact.Destroy();
-
-		}
+		bullet.Destroy();
 	}
 
 };
@@ -683,7 +694,8 @@ public:
 	}
 
 	int myDroneNumber = 10;
-	std::vector<drone*> myPeasents;
+	int spawnedDrones = 0;
+	std::vector<GameEngine::EntityHandle> myPeasents;
 	float time = 0.f;
 	float spawnCooldown = 0.3f;
 
@@ -698,18 +710,19 @@ public:
 				if (time > spawnCooldown) 
 				{
 					drone* peasent = new drone(true, false, true);
-					float phaseOffset = myPeasents.size() * 0.2f;
-					myPeasents.push_back(peasent);
+					float phaseOffset = spawnedDrones * 0.2f;
 					peasent->position.x = position.x + phaseOffset;
 					peasent->position.y = position.y;
 					peasent->phaseOffset = phaseOffset;
 					engine.getLevel().addObject(peasent);
+					myPeasents.push_back(peasent->handle);
 					time = 0;
 					myDroneNumber--;
+					spawnedDrones++;
 				}
 		}
 
-		removeNullPointers(myPeasents);
+		removeDeadHandles(myPeasents);
 
 		if (myPeasents.empty() && myDroneNumber == 0)
 		{
@@ -731,7 +744,7 @@ public:
 	float time = 0.0f;
 
 	void OnStart() override {
-		objectGroup = "MASpwaner";
+		objectGroup = groups::MASpwaner;
 	}
 
 	void OnUpdate() override {
@@ -760,7 +773,7 @@ public:
 
 
 	void OnStart() override {
-		objectGroup = "SASpwaner";
+		objectGroup = groups::SASpwaner;
 	}
 
 	void OnUpdate() override {
@@ -818,7 +831,7 @@ public:
 	void ShootCheck() {
 		if (input.IsGamepadButtonPressed(GamepadButton::A, false)) {
 			if (!keyPressed) {
-				missile* bullet = new missile(true, true, true);
+				missile* bullet = missilePool.Spawn();
 				bullet->position.x = position.x + bulletOffset.x;
 				bullet->position.y = position.y + bulletOffset.y;
 				bullet->firePower = firePower;
@@ -855,7 +868,8 @@ public:
 
 		
 		animation = new Animation("resources/graphics/clone.bmp", 0.1f, textureDimentions, true, { 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15});
-		objectGroup = "companion";
+		objectGroup = groups::companion;
+		renderLayer = RenderLayer::Player;
 		collisionBoxSize.w = collisionBoxSize.h = 32.0f;
 		rotation = globalRotation;
 	}
@@ -891,36 +905,38 @@ public:
 		}
 	}
 
-	void OnCollideEnter(GameObject& contact) override 
+	// Called by the collision handlers set up in main
+	void OnEnemyBulletHit(GameObject& bullet)
 	{
-		if (contact.objectGroup == "enemyBullet") {
-			explosion* boom = new explosion();
-			boom->position.x = position.x;
-			boom->position.y = position.y;
-			std::cout << "Companion Taking Damage" << std::endl;
-			isInit = false;
-			animation = new Animation("resources/graphics/clone.bmp", 1.f, textureDimentions, false, {19});
-			engine.getLevel().addObject(boom);
-			TakeShipDamage();
-			contact.Destroy();
-		}
-
-		if (contact.objectGroup == "enemy") {
-			std::cout << "Companion Taking Damage" << std::endl;
-			isInit = false;
-			animation = new Animation("resources/graphics/clone.bmp", 0.1f, textureDimentions, false, {19});
-			TakeShipDamage();
-		}
+		explosion* boom = explosionPool.Spawn();
+		boom->position.x = position.x;
+		boom->position.y = position.y;
+		std::cout << "Companion Taking Damage" << std::endl;
+		isInit = false;
+		animation = new Animation("resources/graphics/clone.bmp", 1.f, textureDimentions, false, {19});
+		engine.getLevel().addObject(boom);
+		TakeShipDamage();
+		bullet.Destroy();
+	}
+
+	void OnEnemyHit(GameObject& enemy)
+	{
+		std::cout << "Companion Taking Damage" << std::endl;
+		isInit = false;
+		animation = new Animation("resources/graphics/clone.bmp", 0.1f, textureDimentions, false, {19});
+		TakeShipDamage();
+	}
 
-		if (contact.objectGroup == "powerUpMissile") {
-			UpgradeFirePower();
-			contact.Destroy();
-		}
+	void OnMissilePowerUp(GameObject& powerUp)
+	{
+		UpgradeFirePower();
+		powerUp.Destroy();
+	}
 
-		if (contact.objectGroup == "powerUpHeal") {
-			HealShip();
-			contact.Destroy();
-		}
+	void OnHealPowerUp(GameObject& powerUp)
+	{
+		HealShip();
+		powerUp.Destroy();
 	}
 };
 
@@ -943,7 +959,7 @@ public:
 	float damageCooldown = 0;
 	bool onAnimation = false;
 
-	std::vector<companion*> myCompanions;
+	std::vector<GameEngine::EntityHandle> myCompanions;
 
 	void OnStart() override {
 
@@ -961,7 +977,8 @@ public:
 		bulletOffset.y = 24;
 
 		animationState = 0;
-		objectGroup = "player";
+		objectGroup = groups::player;
+		renderLayer = RenderLayer::Player;
 
 		position.x = 0.0f;
 		position.y = -100.0f;
@@ -980,17 +997,18 @@ public:
 
 		if (isGameOver == false)
 		{
-			if (myCompanions.size() > 0)
-			{
-				for (int i = 0; i < myCompanions.size(); i++)
+			// Drops removed companions and destroys the beaten ones in one pass
+			myCompanions.erase(std::remove_if(myCompanions.begin(), myCompanions.end(), [](GameEngine::EntityHandle handle) {
+				companion* wingman = engine.getObjectAs<companion>(handle);
+				if (wingman == nullptr)
+					return true;
+				if (wingman->shipHealth <= 0)
 				{
-					if (myCompanions[i]->shipHealth <= 0)
-					{
-						myCompanions[i]->Destroy();
-						myCompanions.erase(myCompanions.begin() + i);
-					}
+					wingman->Destroy();
+					return true;
 				}
-			}
+				return false;
+			}), myCompanions.end());
 
 			ShootCheck();
 			checkDamageCooldown();
@@ -1014,13 +1032,12 @@ public:
 			}
 		}
 
-		if (myCompanions.size() > 0)
+		removeDeadHandles(myCompanions);
+		for (int i = 0; i < myCompanions.size(); i++)
 		{
-			for (int i = 0; i < myCompanions.size(); i++)
-			{
-				myCompanions[i]->position.x = position.x + companionOffset[i];
-				myCompanions[i]->position.y = position.y;
-			}
+			companion* wingman = engine.getObjectAs<companion>(myCompanions[i]);
+			wingman->position.x = position.x + companionOffset[i];
+			wingman->position.y = position.y;
 		}
 
 		if (animationState == 1 && currentAnimation != "Right" && onAnimation == false)
@@ -1045,15 +1062,14 @@ public:
 
 		if (shipHealth <= 0 && isGameOver == false) {
 
-			if (myCompanions.size() > 0)
+			for (int i = myCompanions.size() - 1; i >= 0; i--)
 			{
-				for (int i = myCompanions.size() - 1; i >= 0; i--)
-				{
-					std::cout << "my Companion index: " << i << std::endl;
-					myCompanions[i]->Destroy();
-					myCompanions.erase(myCompanions.begin() + i);
-				}
+				std::cout << "my Companion index: " << i << std::endl;
+				companion* wingman = engine.getObjectAs<companion>(myCompanions[i]);
+				if (wingman != nullptr)
+					wingman->Destroy();
 			}
+			myCompanions.clear();
 			isGameOver = true;
 			Destroy();
 		}
@@ -1082,88 +1098,86 @@ public:
 		if (myCompanions.size() < 2)
 		{
 			companion* companion1 = new companion(true, false, true);
-			myCompanions.push_back(companion1);
 			engine.getLevel().addObject(companion1);
+			myCompanions.push_back(companion1->handle);
 		}
 	}
 
-	void OnCollideEnter(GameObject& contact) override {
+	// Called by the collision handlers set up in main
+	void OnEnemyBulletHit(GameObject& bullet) {
 
 		int textureDimentions2[2] = { 7,3 };
 
-		
-		if (contact.objectGroup == "enemyBullet") {
-			explosion* boom = new explosion();
-			boom->position.x = position.x;
-			boom->position.y = position.y;
-			if (animationState == 1 && currentAnimation != "Right")
-			{
-				currentAnimation = "Up";
-				isInit = false;
-				onAnimation = true;
-				animation = new Animation("resources/graphics/Ship2.bmp", 0.1f, textureDimentions2, false,
-					{
-					4,5,6, 4,5,6, 4,5,6,
-					11,12,13, 11,12,13, 11,12,13,
-					18,19,20,18,19,20,18,19,20
-					}
-				);
+		explosion* boom = explosionPool.Spawn();
+		boom->position.x = position.x;
+		boom->position.y = position.y;
+		if (animationState == 1 && currentAnimation != "Right")
+		{
+			currentAnimation = "Up";
+			isInit = false;
+			onAnimation = true;
+			animation = new Animation("resources/graphics/Ship2.bmp", 0.1f, textureDimentions2, false,
+				{
+				4,5,6, 4,5,6, 4,5,6,
+				11,12,13, 11,12,13, 11,12,13,
+				18,19,20,18,19,20,18,19,20
+				}
+			);
 
-			}
-			else if (animationState == 2 && currentAnimation != "Left")
-			{
-				currentAnimation = "Down";
-				isInit = false;
-				onAnimation = true;
-				animation = new Animation("resources/graphics/Ship2.bmp", 0.1f, textureDimentions2, false,
-					{
-					0,1,2, 0,1,2,0,1,2,
-					9,8,7, 9,8,7,9,8,7,
-					16,15,14, 16,15,14,16,15,14
-					}
-				);
+		}
+		else if (animationState == 2 && currentAnimation != "Left")
+		{
+			currentAnimation = "Down";
+			isInit = false;
+			onAnimation = true;
+			animation = new Animation("resources/graphics/Ship2.bmp", 0.1f, textureDimentions2, false,
+				{
+				0,1,2, 0,1,2,0,1,2,
+				9,8,7, 9,8,7,9,8,7,
+				16,15,14, 16,15,14,16,15,14
+				}
+			);
 
-			}
-			else if (animationState == 0 && currentAnimation != "Idle")
-			{
-				currentAnimation = "Idle";
-				isInit = false;
-				onAnimation = true;
-				animation = new Animation("resources/graphics/Ship2.bmp", 0.1f, textureDimentions2, false,
-					{
-						3, 10, 17,3, 10, 17,3, 10, 17
-					}
-				);
+		}
+		else if (animationState == 0 && currentAnimation != "Idle")
+		{
+			currentAnimation = "Idle";
+			isInit = false;
+			onAnimation = true;
+			animation = new Animation("resources/graphics/Ship2.bmp", 0.1f, textureDimentions2, false,
+				{
+					3, 10, 17,3, 10, 17,3, 10, 17
+				}
+			);
 
-			}
-			engine.getLevel().addObject(boom);
-			TakeShipDamage();
-			//std::cout << "Ship Damaged by " << contact.objectGroup << std::endl;
-			contact.Destroy();
 		}
+		engine.getLevel().addObject(boom);
+		TakeShipDamage();
+		//std::cout << "Ship Damaged by " << bullet.objectGroup.GetName() << std::endl;
+		bullet.Destroy();
+	}
 
-		if (contact.objectGroup == "enemy") {
-			animation = new Animation("resources/graphics/Ship2.bmp", 0.1f, textureDimentions, false, { 3, 10, 17,3, 10, 17,3, 10, 17 });
+	void OnEnemyHit(GameObject& enemy) {
+		animation = new Animation("resources/graphics/Ship2.bmp", 0.1f, textureDimentions, false, { 3, 10, 17,3, 10, 17,3, 10, 17 });
 
-			TakeShipDamage();
-			//std::cout << "Ship Damaged by " << contact.objectGroup << std::endl;
-		}
-		
-		if (contact.objectGroup == "powerUpMissile") {
-			UpgradeFirePower();
-			contact.Destroy();
-		}
+		TakeShipDamage();
+		//std::cout << "Ship Damaged by " << enemy.objectGroup.GetName() << std::endl;
+	}
 
-		if (contact.objectGroup == "powerUpCompanion") {
-			RecruitCompanion();
-			std::cout << "Power UP Companion" << std::endl;
-			contact.Destroy();
-		}
+	void OnMissilePowerUp(GameObject& powerUp) {
+		UpgradeFirePower();
+		powerUp.Destroy();
+	}
 
-		if (contact.objectGroup == "powerUpHeal") {
-			HealShip();
-			contact.Destroy();
-		}
+	void OnCompanionPowerUp(GameObject& powerUp) {
+		RecruitCompanion();
+		std::cout << "Power UP Companion" << std::endl;
+		powerUp.Destroy();
+	}
+
+	void OnHealPowerUp(GameObject& powerUp) {
+		HealShip();
+		powerUp.Destroy();
 	}
 
 };
@@ -1180,7 +1194,7 @@ public:
 	float time = 0.0f;
 
 	void OnStart() override {
-		objectGroup = "RSpwaner";
+		objectGroup = groups::RSpwaner;
 	}
 
 	void OnUpdate() override {
@@ -1208,7 +1222,7 @@ public:
 	float time = 0.0f;
 
 	void OnStart() override {
-		objectGroup = "RSpwaner";
+		objectGroup = groups::RSpwaner;
 	}
 
 	void OnUpdate() override {
@@ -1228,7 +1242,7 @@ class lonerSpawner : public GameObject
 {
 public:
 	void OnStart() override {
-		objectGroup = "LSpwaner";
+		objectGroup = groups::LSpwaner;
 
 		position.x = 0;
 	}
@@ -1257,8 +1271,6 @@ public:
 	backgroundAssets(std::string filepath, float sizeX, float sizeY, float posX, float posY, bool tile, int rows, int columns, int numTilesX, int numTilesY, std::vector<int> tileIDs)
 		: LevelBackground(filepath, sizeX, sizeY, posX, posY, tile, rows, columns, numTilesX, numTilesY, tileIDs)
 	{
-		// Initialize tiledVertices with default values
-		std::fill(std::begin(tiledVertices), std::end(tiledVertices), 0.0f);
 	}
 
 	void OnUpdate() override
@@ -1281,7 +1293,500 @@ public:
 	{}
 };
 
-int main()
+// Sprite stress scene, run with --stress. Ramps the sprite count up and prints
+// how draw calls and frame time scale with it. --stress-bodies gives every sprite a Box2D body.
+// A few pooled enemy bullets are spawned and despawned every frame. Built with XENON_COUNT_ALLOCATIONS
+// it also prints the heap allocations per frame, which show whether that churn allocates once the
+// pool has grown in the warmup.
+class stressSprite : public GameObject
+{
+public:
+	stressSprite(bool visibility = true, bool isBullet = false, bool hasSense = false)
+		: GameObject(visibility, isBullet, hasSense) {
+		hasBox2d = false;
+		objectGroup = groups::stress;
+	}
+
+	struct
+	{
+		float x = 0.0f;
+		float y = 0.0f;
+	}velocity;
+
+	void OnStart() override {
+		int textureDimentions[2];
+
+		switch (getRandomInt(0, 3)) {
+		case 0:
+			textureDimentions[0] = 2;
+			textureDimentions[1] = 3;
+			animation = new Animation("resources/graphics/missile.bmp", 0.1f, textureDimentions, true, { 0, 1 });
+			collisionBoxSize.w = collisionBoxSize.h = 16.0f;
+			break;
+		case 1:
+			textureDimentions[0] = 8;
+			textureDimentions[1] = 1;
+			animation = new Animation("resources/graphics/EnWeap6.bmp", 0.1f, textureDimentions, true, {});
+			collisionBoxSize.w = collisionBoxSize.h = 16.0f;
+			break;
+		default:
+			textureDimentions[0] = 5;
+			textureDimentions[1] = 2;
+			animation = new Animation("resources/graphics/explode64.bmp", 0.1f, textureDimentions, true, {});
+			collisionBoxSize.w = collisionBoxSize.h = 32.0f;
+			break;
+		}
+
+		velocity.x = getRandomFloat(-100.f, 100.f);
+		velocity.y = getRandomFloat(-100.f, 100.f);
+	}
+
+	void OnUpdate() override {
+		position.x += velocity.x * engine.deltaTime;
+		position.y += velocity.y * engine.deltaTime;
+
+		if (position.x > 320.f || position.x < -320.f) {
+			velocity.x = -velocity.x;
+		}
+		if (position.y > 240.f || position.y < -240.f) {
+			velocity.y = -velocity.y;
+		}
+	}
+};
+
+class stressDirector : public GameObject
+{
+public:
+	stressDirector(bool visibility = false, bool isBullet = false, bool hasSense = false)
+		: GameObject(visibility, isBullet, hasSense) {
+		hasBox2d = false;
+	}
+
+	std::vector<int> spriteSteps = { 100, 1000, 5000, 10000, 25000, 50000 };
+	bool withBodies = false;
+	int currentStep = 0;
+	int spawned = 0;
+
+	float warmupTime = 1.0f;
+	float sampleTime = 3.0f;
+	float time = 0.0f;
+
+	int sampledFrames = 0;
+	int lastSampledFrame = 0;
+	float frameTimeSum = 0.0f;
+	float sortTimeSum = 0.0f;
+	float submitTimeSum = 0.0f;
+	float physicsTimeSum = 0.0f;
+	int drawCallSum = 0;
+	// One sample at 5k sprites in software mode is already past 1.5e7 pixels
+	long long pixelSum = 0;
+	int issuedSum = 0;
+	int elidedSum = 0;
+	long long allocationsAtSampleStart = 0;
+	int frameAtSampleStart = 0;
+
+	// Each lives about ten frames before it leaves its mover bounds
+	int churnPerFrame = 4;
+
+	void OnUpdate() override {
+		if (currentStep >= spriteSteps.size()) {
+			engine.quit();
+			return;
+		}
+
+		for (int i = 0; i < churnPerFrame; ++i) {
+			enemyProjectile* bullet = enemyProjectilePool.Spawn();
+			bullet->position.x = getRandomFloat(-300.f, 300.f);
+			bullet->position.y = getRandomFloat(-240.f, -200.f);
+			engine.getLevel().addObject(bullet);
+		}
+
+		while (spawned < spriteSteps[currentStep]) {
+			stressSprite* sprite = new stressSprite();
+			sprite->hasBox2d = withBodies;
+			sprite->position.x = getRandomFloat(-300.f, 300.f);
+			sprite->position.y = getRandomFloat(-220.f, 220.f);
+			engine.getLevel().addObject(sprite);
+			spawned++;
+		}
+
+		time += engine.deltaTime;
+		if (time < warmupTime) {
+#ifdef XENON_COUNT_ALLOCATIONS
+			allocationsAtSampleStart = heapAllocations;
+#endif
+			frameAtSampleStart = engine.getRenderStats().frame;
+			return;
+		}
+
+		const GameEngine::RenderStats& stats = engine.getRenderStats();
+		// OnUpdate runs every tick, a frame that caught up with several is still one sample
+		if (stats.frame == lastSampledFrame)
+			return;
+		lastSampledFrame = stats.frame;
+		frameTimeSum += stats.frameTimeMs;
+		sortTimeSum += stats.sortTimeMs;
+		submitTimeSum += stats.submitTimeMs;
+		physicsTimeSum += stats.physicsTimeMs;
+		drawCallSum += stats.drawCalls;
+		pixelSum += stats.pixelsFilled;
+		issuedSum += stats.stateChangesIssued;
+		elidedSum += stats.stateChangesElided;
+		sampledFrames++;
+
+		if (time > warmupTime + sampleTime) {
+			std::cout << "Sprites: " << spawned
+				<< " | Draw calls: " << drawCallSum / sampledFrames
+				<< " | Frame time: " << frameTimeSum / sampledFrames << " ms"
+				<< " | Sort: " << sortTimeSum / sampledFrames << " ms"
+				<< " | Submit: " << submitTimeSum / sampledFrames << " ms"
+				<< " | Physics: " << physicsTimeSum / sampledFrames << " ms"
+				<< " | Binds issued/elided: " << issuedSum / sampledFrames << "/" << elidedSum / sampledFrames
+				<< " | Pixels filled: " << pixelSum / sampledFrames;
+#ifdef XENON_COUNT_ALLOCATIONS
+			std::cout << " | Allocations/frame: " << (double)(heapAllocations - allocationsAtSampleStart) / (std::max)(stats.frame - frameAtSampleStart, 1);
+#endif
+			std::cout << std::endl;
+
+			const GameEngine::TextureCache::Stats& textures = engine.getTextureCacheStats();
+			std::cout << "Textures: " << textures.residentTextures
+				<< " | Resident: " << textures.residentBytes / 1024 << " KB"
+				<< " | Hits: " << textures.hits << " | Misses: " << textures.misses << std::endl;
+
+			currentStep++;
+			time = 0.0f;
+			sampledFrames = 0;
+			frameTimeSum = 0.0f;
+			sortTimeSum = 0.0f;
+			submitTimeSum = 0.0f;
+			physicsTimeSum = 0.0f;
+			drawCallSum = 0;
+			pixelSum = 0;
+			issuedSum = 0;
+			elidedSum = 0;
+		}
+	}
+};
+
+// Collision benchmark, run with --collision-bench and once more with --dynamic-bodies or
+// --projectile-bench, which tests the same bodies in the projectile grid instead of Box2D.
+// --worker-bench samples the Box2D path at 1, 2, 4 and 8 physics workers in one run.
+// Packs 2000 bodies into a small area so nearly every pair overlaps and prints the
+// physics and solver time per frame.
+class collisionBenchBody : public GameObject
+{
+public:
+	collisionBenchBody(bool visibility = true, bool isBullet = false, bool hasSense = false)
+		: GameObject(visibility, isBullet, hasSense) {
+		objectGroup = groups::bench;
+		collisionBoxSize.w = collisionBoxSize.h = 16.0f;
+	}
+
+	static int enterEvents;
+
+	void OnUpdate() override {
+		// A little drift keeps the broadphase busy
+		position.x += getRandomFloat(-20.f, 20.f) * engine.deltaTime;
+		position.y += getRandomFloat(-20.f, 20.f) * engine.deltaTime;
+	}
+
+	void OnCollideEnter(GameObject& contact) override {
+		enterEvents++;
+	}
+};
+
+int collisionBenchBody::enterEvents = 0;
+
+class collisionBenchDirector : public GameObject
+{
+public:
+	collisionBenchDirector(bool visibility = false, bool isBullet = false, bool hasSense = false)
+		: GameObject(visibility, isBullet, hasSense) {
+		hasBox2d = false;
+	}
+
+	int bodyCount = 2000;
+	bool spawned = false;
+
+	float warmupTime = 1.0f;
+	float sampleTime = 3.0f;
+	float time = 0.0f;
+
+	int sampledFrames = 0;
+	int lastSampledFrame = 0;
+	float physicsTimeSum = 0.0f;
+	float solveTimeSum = 0.0f;
+
+	// Physics worker counts to sample one after another, empty samples the current setup once
+	std::vector<int> workerCounts;
+	size_t workerPhase = 0;
+
+	void OnUpdate() override {
+		if (!spawned) {
+			if (!workerCounts.empty())
+				engine.setPhysicsWorkers(workerCounts[0]);
+			for (int i = 0; i < bodyCount; ++i) {
+				collisionBenchBody* body = new collisionBenchBody();
+				body->position.x = getRandomFloat(-100.f, 100.f);
+				body->position.y = getRandomFloat(-100.f, 100.f);
+				engine.getLevel().addObject(body);
+			}
+			spawned = true;
+			return;
+		}
+
+		time += engine.deltaTime;
+		if (time < warmupTime) {
+			collisionBenchBody::enterEvents = 0;
+			return;
+		}
+
+		const GameEngine::RenderStats& stats = engine.getRenderStats();
+		if (stats.frame == lastSampledFrame)
+			return;
+		lastSampledFrame = stats.frame;
+		physicsTimeSum += stats.physicsTimeMs;
+		solveTimeSum += stats.physicsSolveMs;
+		sampledFrames++;
+
+		if (time > warmupTime + sampleTime) {
+			if (!workerCounts.empty())
+				std::cout << "Workers: " << workerCounts[workerPhase] << " | ";
+			std::cout << "Bodies: " << bodyCount
+				<< " | Physics: " << physicsTimeSum / sampledFrames << " ms"
+				<< " | Solve: " << solveTimeSum / sampledFrames << " ms"
+				<< " | Enter events: " << collisionBenchBody::enterEvents << std::endl;
+
+			// The next worker count rebuilds the world, which warms up again
+			if (++workerPhase < workerCounts.size()) {
+				engine.setPhysicsWorkers(workerCounts[workerPhase]);
+				time = 0.0f;
+				sampledFrames = 0;
+				physicsTimeSum = 0.0f;
+				solveTimeSum = 0.0f;
+				return;
+			}
+			engine.quit();
+		}
+	}
+};
+
+// Entity benchmark, run with --entity-bench. Fills the EntityWorld with 10k and then 100k
+// moving entities and prints the time the built-in systems take per frame. One in a hundred
+// has a Sprite, so the draw path is part of the frame time.
+class entityBenchDirector : public GameObject
+{
+public:
+	entityBenchDirector(bool visibility = false, bool isBullet = false, bool hasSense = false)
+		: GameObject(visibility, isBullet, hasSense) {
+		hasBox2d = false;
+	}
+
+	std::vector<int> entitySteps = { 10000, 100000 };
+	int currentStep = 0;
+	int spawned = 0;
+	unsigned int texture = 0;
+
+	float warmupTime = 1.0f;
+	float sampleTime = 3.0f;
+	float time = 0.0f;
+
+	int sampledFrames = 0;
+	int lastSampledFrame = 0;
+	float entityTimeSum = 0.0f;
+	float frameTimeSum = 0.0f;
+
+	void OnUpdate() override {
+		if (currentStep >= entitySteps.size()) {
+			engine.quit();
+			return;
+		}
+
+		if (texture == 0)
+			texture = engine.acquireTexture("resources/graphics/EnWeap6.bmp");
+
+		GameEngine::EntityWorld& world = engine.getWorld();
+		while (spawned < entitySteps[currentStep]) {
+			GameEngine::Transform transform;
+			transform.x = transform.previousX = getRandomFloat(-300.f, 300.f);
+			transform.y = transform.previousY = getRandomFloat(-220.f, 220.f);
+			GameEngine::Velocity velocity;
+			velocity.x = getRandomFloat(-50.f, 50.f);
+			velocity.y = getRandomFloat(-50.f, 50.f);
+			GameEngine::Lifetime lifetime;
+			lifetime.seconds = 1000.f;
+			GameEngine::EntityHandle entity = world.Create(transform, velocity, lifetime, GameEngine::Health());
+
+			if (spawned % 100 == 0) {
+				GameEngine::Sprite sprite;
+				sprite.texture = texture;
+				sprite.w = sprite.h = 16.f;
+				sprite.u1 = 1.f / 8.f;
+				sprite.layer = RenderLayer::Bullets;
+				world.Add(entity, sprite);
+			}
+			spawned++;
+		}
+
+		time += engine.deltaTime;
+		if (time < warmupTime) {
+			return;
+		}
+
+		const GameEngine::RenderStats& stats = engine.getRenderStats();
+		if (stats.frame == lastSampledFrame)
+			return;
+		lastSampledFrame = stats.frame;
+		entityTimeSum += stats.entityUpdateMs;
+		frameTimeSum += stats.frameTimeMs;
+		sampledFrames++;
+
+		if (time > warmupTime + sampleTime) {
+			std::cout << "Entities: " << spawned
+				<< " | Entity systems: " << entityTimeSum / sampledFrames << " ms"
+				<< " | Frame time: " << frameTimeSum / sampledFrames << " ms" << std::endl;
+
+			currentStep++;
+			time = 0.0f;
+			sampledFrames = 0;
+			entityTimeSum = 0.0f;
+			frameTimeSum = 0.0f;
+		}
+	}
+};
+
+// Mover benchmark, run with --mover-bench. Moves 10k, 100k and then 1M objects straight down,
+// first each in its own OnUpdate and then as engine movers, and prints the tick time of both.
+// Four body types are mixed like the bullets, asteroids and enemies of a level, so OnUpdate
+// is not the same call every time. No object leaves its bounds in less than 7 seconds.
+class moverBenchBody : public GameObject
+{
+public:
+	moverBenchBody(float speed, bool kinematic, bool visibility = false, bool isBullet = false, bool hasSense = false)
+		: GameObject(visibility, isBullet, hasSense), moveSpeed(speed) {
+		hasBox2d = false;
+		objectGroup = groups::bench;
+		if (kinematic) {
+			mover.enabled = true;
+			mover.velocityY = -moveSpeed;
+			mover.minY = -800.f;
+		}
+	}
+
+	float moveSpeed;
+};
+
+template <int Kind>
+class moverBenchKind : public moverBenchBody
+{
+public:
+	moverBenchKind(bool kinematic) : moverBenchBody(20.f * (Kind + 1), kinematic) {}
+
+	void OnUpdate() override {
+		position.y -= moveSpeed * engine.deltaTime;
+
+		if (position.y < -800.f) {
+			Destroy();
+		}
+	}
+};
+
+class moverBenchDirector : public GameObject
+{
+public:
+	moverBenchDirector(bool visibility = false, bool isBullet = false, bool hasSense = false)
+		: GameObject(visibility, isBullet, hasSense) {
+		hasBox2d = false;
+	}
+
+	std::vector<int> moverSteps = { 10000, 100000, 1000000 };
+	int currentStep = 0;
+	// Every step runs with OnUpdate first and with the mover system second
+	bool kinematic = false;
+	std::vector<moverBenchBody*> bodies;
+	// Level size without the bodies. After a step the next one waits until the delete pass at the
+	// end of the frame dropped the last body, so two steps never hold handles at the same time.
+	size_t levelSizeWithoutBodies = 0;
+	bool waitingForCleanup = false;
+
+	float warmupTime = 1.0f;
+	float sampleTime = 3.0f;
+	float time = 0.0f;
+
+	int sampledFrames = 0;
+	int lastSampledFrame = 0;
+	int sampledSteps = 0;
+	float physicsTimeSum = 0.0f;
+	float moverTimeSum = 0.0f;
+
+	void OnUpdate() override {
+		if (currentStep >= moverSteps.size()) {
+			engine.quit();
+			return;
+		}
+
+		if (bodies.empty()) {
+			if (waitingForCleanup) {
+				if (engine.getLevel().levelObjects.size() > levelSizeWithoutBodies)
+					return;
+				waitingForCleanup = false;
+			}
+			levelSizeWithoutBodies = engine.getLevel().levelObjects.size();
+			bodies.reserve(moverSteps[currentStep]);
+			for (int i = 0; i < moverSteps[currentStep]; ++i) {
+				moverBenchBody* body = nullptr;
+				switch (getRandomInt(0, 4)) {
+				case 0: body = new moverBenchKind<0>(kinematic); break;
+				case 1: body = new moverBenchKind<1>(kinematic); break;
+				case 2: body = new moverBenchKind<2>(kinematic); break;
+				default: body = new moverBenchKind<3>(kinematic); break;
+				}
+				body->position.x = getRandomFloat(-300.f, 300.f);
+				body->position.y = getRandomFloat(-220.f, 220.f);
+				engine.getLevel().addObject(body);
+				bodies.push_back(body);
+			}
+			return;
+		}
+
+		time += engine.deltaTime;
+		if (time < warmupTime) {
+			return;
+		}
+
+		const GameEngine::RenderStats& stats = engine.getRenderStats();
+		if (stats.frame == lastSampledFrame)
+			return;
+		lastSampledFrame = stats.frame;
+		physicsTimeSum += stats.physicsTimeMs;
+		moverTimeSum += stats.moverUpdateMs;
+		sampledSteps += stats.physicsSteps;
+		sampledFrames++;
+
+		if (time > warmupTime + sampleTime) {
+			std::cout << "Objects: " << moverSteps[currentStep]
+				<< (kinematic ? " | Movers" : " | OnUpdate")
+				<< " | Tick: " << physicsTimeSum / (std::max)(sampledSteps, 1) << " ms"
+				<< " | Mover system: " << moverTimeSum / (std::max)(sampledSteps, 1) << " ms" << std::endl;
+
+			for (moverBenchBody* body : bodies)
+				body->Destroy();
+			bodies.clear();
+			waitingForCleanup = true;
+
+			if (kinematic)
+				currentStep++;
+			kinematic = !kinematic;
+			time = 0.0f;
+			sampledFrames = 0;
+			sampledSteps = 0;
+			physicsTimeSum = 0.0f;
+			moverTimeSum = 0.0f;
+		}
+	}
+};
+
+int main(int argc, char* argv[])
 {
 	GameWindow gameWindow;
 	gameWindow.windowName = "Xenon 2000";
@@ -1308,6 +1813,173 @@ int main()
 
 	engine.setLevel(level);
 
+	// Instanced with GPU animation is the default so rotation and damage flashing show up,
+	// --batched, --cpu-animation and --animate-offscreen compare against the older paths.
+	// --headless runs without a window, --frames N stops after N frames.
+	// --software rasterizes on the CPU, --capture DIR writes every frame and --golden DIR
+	// compares every frame against an earlier capture. --seed N fixes the random waves,
+	// capture and golden runs use seed 0 unless told otherwise.
+	// --dynamic-bodies goes back to solver driven collisions, --collision-bench compares the two.
+	// --box2d-bullets keeps bullets in Box2D instead of the projectile grid.
+	// --physics-workers N steps Box2D on N threads.
+	// --entity-bench times the systems of the EntityWorld.
+	// --mover-bench compares objects moved in OnUpdate with engine movers.
+	bool stress = false;
+	bool stressBodies = false;
+	bool collisionBench = false;
+	bool workerBench = false;
+	bool entityBench = false;
+	bool moverBench = false;
+	bool box2dBullets = false;
+	bool fixedSeed = false;
+	unsigned int seed = 0;
+	engine.setRenderMode(GameEngine::RenderMode::Instanced);
+	engine.setAnimationMode(GameEngine::AnimationMode::Gpu);
+	// Waves wait above the screen before they fly in, there is no need to animate them there
+	engine.setOffscreenAnimation(GameEngine::OffscreenAnimation::Lazy);
+	// Every object is moved by its OnUpdate, nothing needs the solver
+	engine.setCollisionMode(GameEngine::CollisionMode::Overlap);
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (std::string(argv[arg]) == "--stress")
+			stress = true;
+		else if (std::string(argv[arg]) == "--stress-bodies")
+			stress = stressBodies = true;
+		else if (std::string(argv[arg]) == "--collision-bench")
+			collisionBench = true;
+		else if (std::string(argv[arg]) == "--projectile-bench")
+		{
+			collisionBench = true;
+			engine.setProjectileGroup("bench", true);
+		}
+		else if (std::string(argv[arg]) == "--worker-bench")
+			collisionBench = workerBench = true;
+		else if (std::string(argv[arg]) == "--entity-bench")
+			entityBench = true;
+		else if (std::string(argv[arg]) == "--mover-bench")
+			moverBench = true;
+		else if (std::string(argv[arg]) == "--physics-workers" && arg + 1 < argc)
+			engine.setPhysicsWorkers(std::atoi(argv[++arg]));
+		else if (std::string(argv[arg]) == "--box2d-bullets")
+			box2dBullets = true;
+		else if (std::string(argv[arg]) == "--dynamic-bodies")
+			engine.setCollisionMode(GameEngine::CollisionMode::Dynamic);
+		else if (std::string(argv[arg]) == "--batched")
+			engine.setRenderMode(GameEngine::RenderMode::Batched);
+		else if (std::string(argv[arg]) == "--cpu-animation")
+			engine.setAnimationMode(GameEngine::AnimationMode::Cpu);
+		else if (std::string(argv[arg]) == "--animate-offscreen")
+			engine.setOffscreenAnimation(GameEngine::OffscreenAnimation::Advance);
+		else if (std::string(argv[arg]) == "--headless")
+			engine.setHeadless(true);
+		else if (std::string(argv[arg]) == "--frames" && arg + 1 < argc)
+			engine.setFrameLimit(std::atoi(argv[++arg]));
+		else if (std::string(argv[arg]) == "--software")
+			engine.setSoftwareRendering(true);
+		else if (std::string(argv[arg]) == "--capture" && arg + 1 < argc)
+		{
+			engine.setFrameCapture(argv[++arg]);
+			fixedSeed = true;
+		}
+		else if (std::string(argv[arg]) == "--golden" && arg + 1 < argc)
+		{
+			engine.setGoldenFrames(argv[++arg]);
+			fixedSeed = true;
+		}
+		else if (std::string(argv[arg]) == "--seed" && arg + 1 < argc)
+		{
+			seed = (unsigned int)std::strtoul(argv[++arg], nullptr, 10);
+			fixedSeed = true;
+		}
+	}
+	if (fixedSeed)
+		randomEngine.seed(seed);
+
+	// Only the pairs some handler reacts to are allowed to touch, so enemies pass through
+	// enemies and bullets pass through the player, power-ups and each other. Objects without a
+	// group, like explosions, touch nothing.
+	const char* collisionGroups[] = { "", "player", "companion", "bullet", "enemy", "enemyBullet", "powerUpMissile", "powerUpHeal", "powerUpCompanion" };
+	for (const char* group : collisionGroups)
+		engine.setGroupCollidesWithAll(group, false);
+	engine.setGroupsCollide("bullet", "enemy", true);
+	engine.setGroupsCollide("enemyBullet", "player", true);
+	engine.setGroupsCollide("enemyBullet", "companion", true);
+	engine.setGroupsCollide("enemy", "player", true);
+	engine.setGroupsCollide("enemy", "companion", true);
+	engine.setGroupsCollide("powerUpMissile", "player", true);
+	engine.setGroupsCollide("powerUpMissile", "companion", true);
+	engine.setGroupsCollide("powerUpHeal", "player", true);
+	engine.setGroupsCollide("powerUpHeal", "companion", true);
+	engine.setGroupsCollide("powerUpCompanion", "player", true);
+
+	// Every group holds a single class, except "enemy" where all classes derive from Enemy,
+	// so the handlers cast without checking
+	engine.setCollisionHandler("bullet", "enemy", [](GameObject& bullet, GameObject& enemy) {
+		static_cast<Enemy&>(enemy).OnMissileHit(static_cast<missile&>(bullet)); });
+	engine.setCollisionHandler("enemyBullet", "player", [](GameObject& bullet, GameObject& player) {
+		static_cast<spaceship&>(player).OnEnemyBulletHit(bullet); });
+	engine.setCollisionHandler("enemyBullet", "companion", [](GameObject& bullet, GameObject& wingman) {
+		static_cast<companion&>(wingman).OnEnemyBulletHit(bullet); });
+	engine.setCollisionHandler("enemy", "player", [](GameObject& enemy, GameObject& player) {
+		static_cast<spaceship&>(player).OnEnemyHit(enemy); });
+	engine.setCollisionHandler("enemy", "companion", [](GameObject& enemy, GameObject& wingman) {
+		static_cast<companion&>(wingman).OnEnemyHit(enemy); });
+	engine.setCollisionHandler("powerUpMissile", "player", [](GameObject& powerUp, GameObject& player) {
+		static_cast<spaceship&>(player).OnMissilePowerUp(powerUp); });
+	engine.setCollisionHandler("powerUpMissile", "companion", [](GameObject& powerUp, GameObject& wingman) {
+		static_cast<companion&>(wingman).OnMissilePowerUp(powerUp); });
+	engine.setCollisionHandler("powerUpHeal", "player", [](GameObject& powerUp, GameObject& player) {
+		static_cast<spaceship&>(player).OnHealPowerUp(powerUp); });
+	engine.setCollisionHandler("powerUpHeal", "companion", [](GameObject& powerUp, GameObject& wingman) {
+		static_cast<companion&>(wingman).OnHealPowerUp(powerUp); });
+	engine.setCollisionHandler("powerUpCompanion", "player", [](GameObject& powerUp, GameObject& player) {
+		static_cast<spaceship&>(player).OnCompanionPowerUp(powerUp); });
+
+	// Bullets are many small boxes that only ever need an overlap test
+	if (!box2dBullets)
+	{
+		engine.setProjectileGroup("bullet", true);
+		engine.setProjectileGroup("enemyBullet", true);
+	}
+
+	// Enough for a busy screen, the pools only allocate again if a wave goes past this
+	missilePool.Reserve(64);
+	enemyProjectilePool.Reserve(64);
+	explosionPool.Reserve(32);
+
+	if (collisionBench)
+	{
+		collisionBenchDirector* director = new collisionBenchDirector();
+		if (workerBench)
+			director->workerCounts = { 1, 2, 4, 8 };
+		engine.getLevel().addObject(director);
+		engine.Initialize(gameWindow);
+		return 0;
+	}
+
+	if (entityBench)
+	{
+		engine.getLevel().addObject(new entityBenchDirector());
+		engine.Initialize(gameWindow);
+		return 0;
+	}
+
+	if (moverBench)
+	{
+		engine.getLevel().addObject(new moverBenchDirector());
+		engine.Initialize(gameWindow);
+		return 0;
+	}
+
+	if (stress)
+	{
+		stressDirector* director = new stressDirector();
+		director->withBodies = stressBodies;
+		engine.getLevel().addObject(director);
+		engine.Initialize(gameWindow);
+		return 0;
+	}
+
 	spaceship* ship = new spaceship();
 	engine.getLevel().addObject(ship);
 	/*